@@ -0,0 +1,306 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/analyzer.hpp"
+#include "audio/bands.hpp"
+#include "audio/constant_q.hpp"
+#include "audio/data.hpp"
+#include "audio/decimator.hpp"
+#include "audio/deinterleave.hpp"
+#include "audio/fft.hpp"
+#include "audio/multi_resolution.hpp"
+#include "audio/spectrum.hpp"
+#include "audio/window.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <numbers>
+#include <span>
+#include <vector>
+
+// every stage is reported per audio frame (one sample of every channel):
+// time/frame in seconds with an SI prefix, allocs/frame on the heap, bytes/frame at least read and written
+// --benchmark_format=json (or the bench-json target) gives the same as machine-readable output
+
+namespace {
+
+std::atomic<std::uint64_t> allocations{ 0 };
+
+void* counted_alloc(std::size_t size, std::size_t alignment) {
+    allocations.fetch_add(1, std::memory_order::relaxed);
+    size = size == 0 ? 1 : size;
+    void* ptr = alignment <= alignof(std::max_align_t)
+                    ? std::malloc(size)
+                    : std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    if (ptr == nullptr) {
+        throw std::bad_alloc{};
+    }
+    return ptr;
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return counted_alloc(size, alignof(std::max_align_t)); }
+void* operator new[](std::size_t size) { return counted_alloc(size, alignof(std::max_align_t)); }
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return counted_alloc(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return counted_alloc(size, static_cast<std::size_t>(alignment));
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+namespace {
+
+constexpr ma_uint32 channels = 2;
+
+audio::DataConfig make_config(std::size_t frame_count) {
+    // no overlap, so one analysed window is exactly frame_count ingested frames
+    return audio::DataConfig{ channels, 48000, frame_count, frame_count * 4, frame_count };
+}
+
+std::vector<float> make_interleaved(std::size_t frame_count) {
+    std::vector<float> interleaved(frame_count * channels);
+    for (std::size_t frame = 0; frame < frame_count; ++frame) {
+        const double t = static_cast<double>(frame) / 48000.0;
+        interleaved[frame * channels + 0] = static_cast<float>(0.5 * std::sin(2.0 * std::numbers::pi * 440.0 * t));
+        interleaved[frame * channels + 1] = static_cast<float>(0.3 * std::sin(2.0 * std::numbers::pi * 1234.5 * t));
+    }
+    return interleaved;
+}
+
+// wraps the timed loop, allocations are counted only inside of it
+class PerFrame {
+public:
+    PerFrame(benchmark::State& state, std::size_t frames, std::size_t bytes_touched)
+        : state_{ state }, frames_{ frames }, bytes_touched_{ bytes_touched },
+          allocations_before_{ allocations.load(std::memory_order::relaxed) } {}
+
+    ~PerFrame() {
+        const auto allocations_during = allocations.load(std::memory_order::relaxed) - allocations_before_;
+        const auto frames = static_cast<double>(frames_);
+        state_.counters["time/frame"] = benchmark::Counter(
+            frames, benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert
+        );
+        state_.counters["allocs/frame"] =
+            benchmark::Counter(static_cast<double>(allocations_during) / frames, benchmark::Counter::kAvgIterations);
+        state_.counters["bytes/frame"] = benchmark::Counter(static_cast<double>(bytes_touched_) / frames);
+        state_.SetBytesProcessed(state_.iterations() * static_cast<std::int64_t>(bytes_touched_));
+    }
+
+private:
+    benchmark::State& state_;
+    std::size_t frames_;
+    std::size_t bytes_touched_;
+    std::uint64_t allocations_before_;
+};
+
+void BM_Ingestion(benchmark::State& state) {
+    const auto frame_count = static_cast<std::size_t>(state.range(0));
+    const audio::DataConfig config = make_config(frame_count);
+    const std::vector<float> interleaved = make_interleaved(frame_count);
+    const auto input = std::as_bytes(std::span{ interleaved });
+    audio::DataCallback callback{ config };
+
+    // producer overruns the consumer here, so this includes reclaiming the oldest frames
+    const PerFrame per_frame{ state, frame_count, 2 * input.size() };
+    for (auto _ : state) {
+        callback(input);
+        benchmark::ClobberMemory();
+    }
+}
+
+void deinterleave(benchmark::State& state, audio::WindowFunction window_function) {
+    const auto frame_count = static_cast<std::size_t>(state.range(0));
+    const audio::Window window{ window_function, frame_count };
+    const std::vector<float> interleaved = make_interleaved(frame_count);
+    const auto input = std::as_bytes(std::span{ interleaved });
+    const std::size_t rows = audio::planar_rows(channels);
+    std::vector<float> planar(rows * frame_count);
+    std::vector<std::span<float>> planar_rows;
+    for (std::size_t row = 0; row < rows; ++row) {
+        planar_rows.push_back(std::span{ planar }.subspan(row * frame_count, frame_count));
+    }
+
+    const PerFrame per_frame{ state, frame_count, input.size() + planar.size() * sizeof(float) };
+    for (auto _ : state) {
+        audio::deinterleave(input, ma_format_f32, channels, planar_rows, window.coefficients());
+        benchmark::DoNotOptimize(planar.data());
+        benchmark::ClobberMemory();
+    }
+}
+
+void BM_Deinterleave(benchmark::State& state) { deinterleave(state, audio::WindowFunction::RECTANGULAR); }
+
+// window fused into the same pass, from a compile time table up to 8192 frames
+void BM_DeinterleaveWindowed(benchmark::State& state) { deinterleave(state, audio::WindowFunction::HANN); }
+
+void BM_Fft(benchmark::State& state) {
+    const auto frame_count = static_cast<std::size_t>(state.range(0));
+    const audio::RealFft fft{ frame_count };
+    std::vector<float> input = make_interleaved(frame_count);
+    input.resize(frame_count);
+    std::vector<std::complex<float>> output(fft.bins());
+
+    const PerFrame per_frame{
+        state, frame_count, input.size() * sizeof(float) + output.size() * sizeof(std::complex<float>)
+    };
+    for (auto _ : state) {
+        fft.forward(input, output);
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+}
+
+// magnitude, log and normalization of one row, the sound level reduction comes out of the same pass
+void BM_SpectrumAndSoundLevel(benchmark::State& state) {
+    const auto frame_count = static_cast<std::size_t>(state.range(0));
+    const audio::RealFft fft{ frame_count };
+    std::vector<float> input = make_interleaved(frame_count);
+    input.resize(frame_count);
+    std::vector<std::complex<float>> bins(fft.bins());
+    fft.forward(input, bins);
+    std::vector<float> normalized(frame_count / 2);
+
+    const PerFrame per_frame{
+        state, frame_count, normalized.size() * (sizeof(std::complex<float>) + sizeof(float))
+    };
+    for (auto _ : state) {
+        float level_sum = audio::normalized_log_spectrum(bins, frame_count, normalized);
+        benchmark::DoNotOptimize(level_sum);
+        benchmark::ClobberMemory();
+    }
+}
+
+// one row into the default number of log bands
+void BM_Bands(benchmark::State& state) {
+    const auto frame_count = static_cast<std::size_t>(state.range(0));
+    const audio::BandMap band_map{ audio::BandConfig{}, frame_count / 2, 48000 };
+    std::vector<float> bins(frame_count / 2);
+    for (std::size_t bin = 0; bin < bins.size(); ++bin) {
+        bins[bin] = std::sin(static_cast<float>(bin));
+    }
+    std::vector<float> bands(band_map.bands());
+
+    const PerFrame per_frame{ state, frame_count, (bins.size() + bands.size()) * sizeof(float) };
+    for (auto _ : state) {
+        band_map.apply(bins, bands);
+        benchmark::DoNotOptimize(bands.data());
+        benchmark::ClobberMemory();
+    }
+}
+
+// polyphase lowpass and downsampling of one planar row, state carried from call to call like in a stream
+void BM_Decimate(benchmark::State& state) {
+    const auto frame_count = static_cast<std::size_t>(state.range(0));
+    const auto factor = static_cast<std::size_t>(state.range(1));
+    audio::Decimator decimator{ factor, frame_count };
+    std::vector<float> input(frame_count);
+    for (std::size_t frame = 0; frame < frame_count; ++frame) {
+        input[frame] = std::sin(static_cast<float>(frame));
+    }
+    std::vector<float> output(frame_count / factor);
+
+    const PerFrame per_frame{ state, frame_count, (input.size() + output.size()) * sizeof(float) };
+    for (auto _ : state) {
+        decimator.process(input, output);
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+}
+
+// sparse kernels over one fft, the lowest bin is where a kernel still fits into it,
+// so bins grow with the fft size and the default 55 hz floor is only reached from 32768 frames at 48 khz
+void BM_ConstantQ(benchmark::State& state) {
+    const auto frame_count = static_cast<std::size_t>(state.range(0));
+    const audio::ConstantQ constant_q{ audio::ConstantQConfig{}, frame_count, 48000 };
+    std::vector<std::complex<float>> fft_bins(frame_count / 2 + 1);
+    for (std::size_t bin = 0; bin < fft_bins.size(); ++bin) {
+        fft_bins[bin] = { std::sin(static_cast<float>(bin)), std::cos(static_cast<float>(bin)) };
+    }
+    std::vector<std::complex<float>> output(constant_q.bins());
+
+    const PerFrame per_frame{ state, frame_count, (fft_bins.size() + output.size()) * sizeof(std::complex<float>) };
+    state.counters["bins"] = static_cast<double>(constant_q.bins());
+    state.counters["coefficients"] = static_cast<double>(constant_q.coefficients());
+    for (auto _ : state) {
+        constant_q.apply(fft_bins, output);
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+}
+
+// whole chain for every planar row: consume, deinterleave, fft, spectrum, rows in parallel like in the app
+void BM_AnalyzerUpdate(benchmark::State& state) {
+    const auto frame_count = static_cast<std::size_t>(state.range(0));
+    const audio::DataConfig config = make_config(frame_count);
+    const std::vector<float> interleaved = make_interleaved(frame_count);
+    const auto input = std::as_bytes(std::span{ interleaved });
+    audio::DataCallback callback{ config };
+    audio::Analyzer analyzer{ config };
+    audio::Spectrum spectrum{ config };
+
+    const PerFrame per_frame{ state, frame_count, input.size() + spectrum.normalized.size() * sizeof(float) };
+    for (auto _ : state) {
+        callback(input);
+        benchmark::DoNotOptimize(analyzer.update(callback, spectrum, false));
+        benchmark::ClobberMemory();
+    }
+}
+
+// same chain with 4 levels of a frame_count / 8 fft over decimated input instead of one frame_count fft
+// one update drains the 8 hops of a window, so every level runs once like the single fft does
+void BM_AnalyzerUpdateMultiResolution(benchmark::State& state) {
+    const auto frame_count = static_cast<std::size_t>(state.range(0));
+    const audio::DataConfig config = make_config(frame_count);
+    const std::vector<float> interleaved = make_interleaved(frame_count);
+    const auto input = std::as_bytes(std::span{ interleaved });
+    audio::DataCallback callback{ config };
+    audio::FftPlanCache fft_plans;
+    audio::Analyzer analyzer{
+        config,
+        fft_plans.real(frame_count),
+        /* parallel_rows = */ true,
+        nullptr,
+        std::make_unique<audio::MultiResolution>(config, audio::MultiResolutionConfig{}, fft_plans),
+    };
+    audio::Spectrum spectrum{ config };
+
+    const PerFrame per_frame{ state, frame_count, input.size() + spectrum.normalized.size() * sizeof(float) };
+    for (auto _ : state) {
+        callback(input);
+        benchmark::DoNotOptimize(analyzer.update(callback, spectrum, false));
+        benchmark::ClobberMemory();
+    }
+}
+
+} // namespace
+
+BENCHMARK(BM_Ingestion)->RangeMultiplier(2)->Range(256, 65536);
+BENCHMARK(BM_Deinterleave)->RangeMultiplier(2)->Range(256, 65536);
+BENCHMARK(BM_DeinterleaveWindowed)->RangeMultiplier(2)->Range(256, 65536);
+BENCHMARK(BM_Fft)->RangeMultiplier(2)->Range(256, 65536);
+BENCHMARK(BM_SpectrumAndSoundLevel)->RangeMultiplier(2)->Range(256, 65536);
+BENCHMARK(BM_Bands)->RangeMultiplier(2)->Range(256, 65536);
+BENCHMARK(BM_Decimate)->ArgsProduct({ benchmark::CreateRange(256, 65536, 4), { 2, 4, 8 } });
+BENCHMARK(BM_ConstantQ)->RangeMultiplier(2)->Range(256, 65536);
+BENCHMARK(BM_AnalyzerUpdate)->RangeMultiplier(2)->Range(256, 65536)->UseRealTime();
+BENCHMARK(BM_AnalyzerUpdateMultiResolution)->RangeMultiplier(2)->Range(512, 65536)->UseRealTime();
+
+BENCHMARK_MAIN();
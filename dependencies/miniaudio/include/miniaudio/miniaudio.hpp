@@ -9,6 +9,7 @@
 #include <sl/meta/monad/result.hpp>
 #include <sl/meta/type/unit.hpp>
 
+#include <cstddef>
 #include <memory>
 #include <span>
 #include <vector>
@@ -32,6 +33,9 @@ struct context_get_devices_result_t {
 
 sl::meta::result<context_get_devices_result_t, ma_result> context_get_devices(const context_uptr& context);
 
+sl::meta::result<ma_device_info, ma_result>
+    context_get_device_info(const context_uptr& context, ma_device_type device_type, const ma_device_id& device_id);
+
 using device_uninit = decltype(&ma_device_uninit);
 using device_uptr = std::unique_ptr<ma_device, device_uninit>;
 sl::meta::result<device_uptr, ma_result>
@@ -40,4 +44,10 @@ sl::meta::result<device_uptr, ma_result>
 sl::meta::result<sl::meta::unit, ma_result> device_start(const device_uptr& device);
 sl::meta::result<sl::meta::unit, ma_result> device_stop(const device_uptr& device);
 
+using decoder_uninit = decltype(&ma_decoder_uninit);
+using decoder_uptr = std::unique_ptr<ma_decoder, decoder_uninit>;
+// data is decoded in place, so it has to outlive the decoder
+sl::meta::result<decoder_uptr, ma_result>
+    decoder_init_memory(std::span<const std::byte> data, const ma_decoder_config& decoder_config);
+
 } // namespace ma
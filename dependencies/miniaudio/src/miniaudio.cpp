@@ -52,6 +52,13 @@ sl::meta::result<context_get_devices_result_t, ma_result> context_get_devices(co
     };
 }
 
+sl::meta::result<ma_device_info, ma_result>
+    context_get_device_info(const context_uptr& context, ma_device_type device_type, const ma_device_id& device_id) {
+    ma_device_info device_info{};
+    MA_UNEXPECTED(ma_context_get_device_info(context.get(), device_type, &device_id, &device_info));
+    return device_info;
+}
+
 sl::meta::result<device_uptr, ma_result>
     device_init(const context_uptr& context, const ma_device_config& device_config) {
     device_uptr device{ new ma_device, &ma_device_uninit };
@@ -69,6 +76,13 @@ sl::meta::result<sl::meta::unit, ma_result> device_stop(const device_uptr& devic
     return sl::meta::unit{};
 }
 
+sl::meta::result<decoder_uptr, ma_result>
+    decoder_init_memory(std::span<const std::byte> data, const ma_decoder_config& decoder_config) {
+    decoder_uptr decoder{ new ma_decoder, &ma_decoder_uninit };
+    MA_UNEXPECTED(ma_decoder_init_memory(data.data(), data.size(), &decoder_config, decoder.get()));
+    return decoder;
+}
+
 #undef MA_UNEXPECTED
 
 } // namespace ma
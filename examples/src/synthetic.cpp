@@ -0,0 +1,62 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/analyzer.hpp"
+#include "audio/synthetic.hpp"
+
+#include <fmt/format.h>
+#include <sl/meta/assert.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+// headless soak run of the ingestion and analysis pipeline, no sound hardware needed
+// usage: synthetic [seconds] [speed], speed 0 generates as fast as possible
+int main(int argc, char** argv) {
+    const double seconds = argc > 1 ? std::atof(argv[1]) : 5.0;
+    const double speed = argc > 2 ? std::atof(argv[2]) : 1.0;
+
+    constexpr audio::DataConfig config{
+        /* .capture_channels = */ 2,
+        /* .sample_rate = */ 48000,
+        /* .frame_count = */ 1024 * 2,
+        /* .max_frame_count = */ 1024 * 16,
+        /* .frame_window = */ 1024,
+    };
+    audio::DataCallback callback{ config };
+    audio::Analyzer analyzer{ config };
+    audio::Spectrum spectrum{ config };
+
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+    const auto end = start + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>{ seconds });
+    std::uint64_t spectra = 0;
+    std::uint64_t generated_frames = 0;
+    {
+        const audio::SyntheticDevice device{ config, audio::SyntheticConfig{ .speed = speed }, callback };
+        while (clock::now() < end) {
+            if (analyzer.update(callback, spectrum, false)) {
+                ++spectra;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        generated_frames = device.generated_frames();
+    }
+
+    const double elapsed = std::chrono::duration<double>{ clock::now() - start }.count();
+    fmt::println(
+        "{:.2f}s: generated {} frames ({:.1f}x real time), {} spectra ({:.1f}/s), dropped {} frames, mid level {:.3f}",
+        elapsed,
+        generated_frames,
+        static_cast<double>(generated_frames) / config.sample_rate / elapsed,
+        spectra,
+        static_cast<double>(spectra) / elapsed,
+        callback.dropped_frames(config),
+        spectrum.level_sums[0] / static_cast<float>(spectrum.bins)
+    );
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include "audio/constant_q.hpp"
+#include "audio/data.hpp"
+#include "audio/fft.hpp"
+#include "audio/fork_join.hpp"
+#include "audio/multi_resolution.hpp"
+#include "audio/window.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace audio {
+
+struct Spectrum {
+    explicit Spectrum(const DataConfig& config);
+    Spectrum(const DataConfig& config, std::size_t bins);
+
+    [[nodiscard]] std::span<const float> row(std::size_t index) const {
+        return std::span{ normalized }.subspan(index * bins, bins);
+    }
+
+public:
+    std::size_t rows; // see planar_rows
+    std::size_t bins; // N / 2, also in multi-resolution, or constant-Q bins
+    std::vector<float> normalized; // ln |X| / ln N, rows x bins, row-major
+    std::vector<float> level_sums; // sum of (normalized + 1) / 2 for each row
+    std::uint64_t generation = 0;
+    capture_clock::time_point captured_at{}; // of the newest frame in the analysed window
+
+    // windowed analysis input and fft output of the first row as of snapshot_generation, only copied on request
+    std::vector<float> time_domain;
+    std::vector<std::complex<float>> freq_domain;
+    std::uint64_t snapshot_generation = 0;
+};
+
+enum class LatencyMode {
+    NEWEST = 0, // skip straight to the newest window
+    CATCH_UP = 1, // analyse windows in order, one per update, skipping those beyond max_backlog
+    ENUM_END,
+};
+
+struct LatencyPolicy {
+    LatencyMode mode = LatencyMode::NEWEST;
+    std::size_t max_backlog = 4; // pending windows, for CATCH_UP
+
+    [[nodiscard]] constexpr std::size_t kept_windows() const {
+        return mode == LatencyMode::NEWEST ? 1 : std::max<std::size_t>(max_backlog, 1);
+    }
+
+    constexpr bool operator==(const LatencyPolicy&) const = default;
+};
+
+// spectrum pipeline: consume -> deinterleave and window into rows -> fft -> [constant-Q] -> normalized log spectrum
+// multi-resolution: consume hops -> deinterleave -> decimate -> fft per level -> stitched normalized log spectrum
+// rows are transformed in parallel, buffers are allocated once in the constructor, fft plan may be shared
+// update does not allocate
+class Analyzer {
+public:
+    explicit Analyzer(const DataConfig& config);
+    // parallel_rows = false keeps everything on the calling thread, for when the caller is already parallel
+    // with constant_q the spectrum has its bins instead of the linear fft ones
+    // with multi_resolution the spectrum keeps the linear bins, fft is then only used for snapshots
+    // window is ignored with constant_q, its kernels are windowed already
+    Analyzer(
+        const DataConfig& config,
+        std::shared_ptr<const RealFft> fft,
+        bool parallel_rows = true,
+        std::shared_ptr<const ConstantQ> constant_q = nullptr,
+        std::unique_ptr<MultiResolution> multi_resolution = nullptr,
+        WindowFunction window_function = WindowFunction::HANN
+    );
+
+    // of the spectra it produces
+    [[nodiscard]] std::size_t bins() const { return constant_q_ ? constant_q_->bins() : config_.frame_count / 2; }
+    [[nodiscard]] bool is_constant_q() const { return static_cast<bool>(constant_q_); }
+    [[nodiscard]] bool is_multi_resolution() const { return static_cast<bool>(multi_resolution_); }
+    [[nodiscard]] WindowFunction window_function() const { return window_.function(); }
+    // frames between two consecutive spectra
+    [[nodiscard]] std::size_t hop() const {
+        return multi_resolution_ ? multi_resolution_->hop() : config_.frame_window;
+    }
+
+    // skips stale windows according to the latency policy and analyses the oldest remaining one
+    // returns false if there was none
+    bool update(DataCallback& callback, Spectrum& spectrum, bool take_snapshot);
+
+    // may be called from another thread than update, takes effect on the next update
+    void set_latency_policy(const LatencyPolicy& policy) {
+        kept_windows_.store(policy.kept_windows(), std::memory_order::relaxed);
+        is_catching_up_.store(policy.mode == LatencyMode::CATCH_UP, std::memory_order::relaxed);
+    }
+
+private:
+    bool update_multi_resolution(DataCallback& callback, Spectrum& spectrum, bool take_snapshot);
+
+private:
+    DataConfig config_;
+    std::shared_ptr<const RealFft> fft_;
+    std::shared_ptr<const ConstantQ> constant_q_;
+    Window window_;
+    std::size_t rows_;
+    std::vector<float> time_domain_; // rows x N
+    std::vector<std::complex<float>> freq_domain_; // rows x (N / 2 + 1)
+    std::vector<std::complex<float>> constant_q_domain_; // rows x constant-Q bins, empty without constant-Q
+    std::vector<std::span<float>> time_domain_rows_;
+    std::unique_ptr<MultiResolution> multi_resolution_;
+    std::vector<float> hop_domain_; // rows x hop, empty without multi-resolution
+    std::vector<std::span<float>> hop_domain_rows_;
+    std::uint64_t generation_ = 0;
+    std::atomic<std::size_t> kept_windows_{ LatencyPolicy{}.kept_windows() };
+    std::atomic<bool> is_catching_up_{ LatencyPolicy{}.mode == LatencyMode::CATCH_UP };
+    ForkJoin fork_join_;
+};
+
+} // namespace audio
@@ -0,0 +1,59 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include <miniaudio/miniaudio.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace audio {
+
+enum class BandScale {
+    LINEAR = 0, // evenly spaced in Hz
+    LOG = 1, // evenly spaced in octaves
+    MEL = 2,
+    BARK = 3,
+    ENUM_END,
+};
+
+struct BandConfig {
+    BandScale scale = BandScale::LOG;
+    std::size_t bands = 256;
+    float min_frequency = 20.0f; // raised to the first non-dc bin
+    float max_frequency = 0.0f; // inclusive, 0 means nyquist
+
+    constexpr bool operator==(const BandConfig&) const = default;
+};
+
+// aggregates linear fft bins into bands evenly spaced on a perceptual scale
+// bin ranges are precomputed, so apply is a single pass without transcendental functions
+// a band wider than a bin takes the peak of its bins, a narrower one interpolates between the two nearest bins
+class BandMap {
+public:
+    BandMap(const BandConfig& config, std::size_t bins, ma_uint32 sample_rate);
+
+    [[nodiscard]] const BandConfig& config() const { return config_; }
+    [[nodiscard]] std::size_t bins() const { return bins_; }
+    [[nodiscard]] std::size_t bands() const { return ranges_.size(); }
+
+    // one row, input.size() == bins(), output.size() == bands()
+    void apply(std::span<const float> input, std::span<float> output) const;
+
+private:
+    struct Range {
+        std::uint32_t first;
+        std::uint32_t last; // exclusive, == first means interpolation between first and first + 1
+        float fraction;
+    };
+
+    BandConfig config_;
+    std::size_t bins_;
+    std::vector<Range> ranges_;
+};
+
+} // namespace audio
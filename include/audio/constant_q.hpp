@@ -0,0 +1,61 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include <miniaudio/miniaudio.hpp>
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace audio {
+
+struct ConstantQConfig {
+    float min_frequency = 55.0f; // A1, raised to what the fft size resolves, see ConstantQ::min_frequency
+    float max_frequency = 0.0f; // 0 means as close to nyquist as the bins per octave allow
+    std::size_t bins_per_octave = 24;
+    float gamma = 0.0f; // bandwidth offset in Hz, 0 is constant-Q, larger values widen the low bins (variable-Q)
+
+    // offset that follows the equivalent rectangular bandwidth of hearing, Schörkhuber et al.
+    [[nodiscard]] static float erb_gamma(std::size_t bins_per_octave);
+
+    constexpr bool operator==(const ConstantQConfig&) const = default;
+};
+
+// constant-Q (or variable-Q) transform computed from the output of the regular fft, Brown and Puckette:
+// every bin is a hann windowed complex exponential whose length follows its bandwidth and fits into the fft size
+// its spectrum is precomputed once and kept sparse, so apply is a short dot product per bin
+class ConstantQ {
+public:
+    ConstantQ(const ConstantQConfig& config, std::size_t fft_size, ma_uint32 sample_rate);
+
+    [[nodiscard]] const ConstantQConfig& config() const { return config_; }
+    [[nodiscard]] std::size_t fft_size() const { return fft_size_; }
+    // of the lowest bin, at least config().min_frequency, but no lower than where the kernel still fits into the fft:
+    // (sample_rate / fft_size - gamma) / alpha, about 800 hz for 2048 frames at 48 khz and 24 bins per octave
+    [[nodiscard]] float min_frequency() const { return min_frequency_; }
+    [[nodiscard]] std::size_t bins() const { return kernels_.size(); }
+    [[nodiscard]] std::size_t coefficients() const { return coefficients_.size(); }
+
+    // input is N / 2 + 1 fft bins, output is scaled by N like the fft, so normalized_log_spectrum applies to it
+    void apply(std::span<const std::complex<float>> input, std::span<std::complex<float>> output) const;
+
+private:
+    struct Kernel {
+        std::uint32_t offset; // into coefficients_
+        std::uint32_t first; // fft bin
+        std::uint32_t count;
+    };
+
+    ConstantQConfig config_;
+    std::size_t fft_size_;
+    float min_frequency_;
+    std::vector<Kernel> kernels_;
+    std::vector<std::complex<float>> coefficients_; // conjugated kernel spectra, back to back
+};
+
+} // namespace audio
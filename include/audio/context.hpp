@@ -5,6 +5,7 @@
 #pragma once
 
 #include "audio/data.hpp"
+#include "perf/realtime.hpp"
 #include <miniaudio/miniaudio.hpp>
 
 #include <sl/meta/lifetime/defer.hpp>
@@ -18,11 +19,14 @@ struct DeviceConfig {
 };
 
 struct Context {
+    // playback only, capture is opened in the format of DataConfig
     static constexpr ma_format format = ma_format_f32;
 
 public:
     explicit Context(
-        const std::vector<ma_backend>& backends = { ma_backend_pulseaudio, ma_backend_coreaudio, ma_backend_wasapi },
+        // null backend is the last resort, so machines without sound hardware still get a (silent) context
+        const std::vector<ma_backend>& backends =
+            { ma_backend_pulseaudio, ma_backend_coreaudio, ma_backend_wasapi, ma_backend_null },
         ma_context_config context_config = ma_context_config_init()
     );
 
@@ -30,6 +34,10 @@ public:
     [[nodiscard]] std::span<ma_device_info> playback_infos() const { return playback_infos_; }
     [[nodiscard]] std::span<ma_device_info> capture_infos() const { return capture_infos_; }
 
+    // format the capture device works in, so that miniaudio does not have to convert anything on its real-time thread
+    // fields the backend does not report are taken from fallback
+    [[nodiscard]] NativeFormat capture_native_format(std::size_t index, const NativeFormat& fallback) const;
+
     template <typename Callable>
     [[nodiscard]] sl::meta::result<ma::device_uptr, ma_result> create_playback_device(
         const DataConfig& data_config,
@@ -38,6 +46,7 @@ public:
     ) const {
         constexpr auto data_callback =
             [](ma_device* device, void* output, [[maybe_unused]] const void* input, ma_uint32 frame_count) {
+                const perf::realtime::Section realtime;
                 (*static_cast<Callable*>(device->pUserData)) //
                     (std::span{ static_cast<float*>(output), frame_count * device->playback.channels });
             };
@@ -53,8 +62,12 @@ public:
     ) const {
         constexpr auto data_callback =
             [](ma_device* device, [[maybe_unused]] void* output, const void* input, ma_uint32 frame_count) {
+                const perf::realtime::Section realtime;
                 (*static_cast<Callable*>(device->pUserData)) //
-                    (std::span{ static_cast<const float*>(input), frame_count * device->capture.channels });
+                    (std::span{
+                        static_cast<const std::byte*>(input),
+                        frame_count * ma_get_bytes_per_frame(device->capture.format, device->capture.channels),
+                    });
             };
 
         return create_device(ma_device_type_capture, data_config, {}, capture_config, data_callback, callable.get());
@@ -68,6 +81,7 @@ public:
         const std::unique_ptr<Callable>& callable
     ) const {
         constexpr auto data_callback = [](ma_device* device, void* output, const void* input, ma_uint32 frame_count) {
+            const perf::realtime::Section realtime;
             (*static_cast<Callable*>(device->pUserData)) //
                 (std::span{ static_cast<float*>(output), frame_count * device->playback.channels },
                  std::span{ static_cast<const float*>(input), frame_count * device->capture.channels });
@@ -86,8 +100,12 @@ public:
     ) const {
         constexpr auto data_callback =
             [](ma_device* device, [[maybe_unused]] void* output, const void* input, ma_uint32 frame_count) {
+                const perf::realtime::Section realtime;
                 (*static_cast<Callable*>(device->pUserData)) //
-                    (std::span{ static_cast<const float*>(input), frame_count * device->capture.channels });
+                    (std::span{
+                        static_cast<const std::byte*>(input),
+                        frame_count * ma_get_bytes_per_frame(device->capture.format, device->capture.channels),
+                    });
             };
 
         return create_device(ma_device_type_loopback, data_config, {}, capture_config, data_callback, callable.get());
@@ -4,32 +4,81 @@
 
 #pragma once
 
+#include "audio/ring.hpp"
+
 #include <concepts>
 #include <miniaudio/miniaudio.hpp>
 
-#include <sl/exec/model/executor.hpp>
-
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <span>
-#include <vector>
 
 namespace audio {
 
+using capture_clock = std::chrono::steady_clock;
+
+constexpr std::size_t bytes_per_sample(ma_format format) {
+    switch (format) {
+    case ma_format_u8:
+        return 1;
+    case ma_format_s16:
+        return 2;
+    case ma_format_s24:
+        return 3;
+    case ma_format_s32:
+    case ma_format_f32:
+        return 4;
+    default:
+        break;
+    }
+    return 0;
+}
+
+// what a device or a file delivers without any conversion
+struct NativeFormat {
+    ma_format format;
+    ma_uint32 channels;
+    ma_uint32 sample_rate;
+};
+
 struct DataConfig {
     constexpr DataConfig(
         ma_uint32 capture_channels,
         ma_uint32 sample_rate,
         std::size_t frame_count,
         std::size_t max_frame_count,
-        std::size_t frame_window
+        std::size_t frame_window,
+        ma_format format = ma_format_f32
     )
         : capture_channels{ capture_channels }, //
           sample_rate{ sample_rate }, //
           frame_count{ frame_count }, //
           max_frame_count{ max_frame_count }, //
           frame_window{ frame_window }, //
+          format{ format }, //
           frame_size{ capture_channels * frame_count }, //
           frame_max_size{ capture_channels * max_frame_count }, //
-          frame_window_size{ static_cast<std::int64_t>(capture_channels * frame_window) } {}
+          frame_window_size{ static_cast<std::int64_t>(capture_channels * frame_window) }, //
+          sample_size{ bytes_per_sample(format) } {}
+
+    // same analysis parameters for a device that delivers a different native format
+    [[nodiscard]] constexpr DataConfig
+        with_device_format(ma_format device_format, ma_uint32 device_channels, ma_uint32 device_sample_rate) const {
+        return DataConfig{
+            device_channels, device_sample_rate, frame_count, max_frame_count, frame_window, device_format,
+        };
+    }
+
+    // window of frame_count frames slides by frame_window frames, frame_window == frame_count means no overlap
+    [[nodiscard]] constexpr bool is_sliding() const { return frame_window < frame_count; }
+    [[nodiscard]] constexpr float hop_rate() const {
+        return static_cast<float>(sample_rate) / static_cast<float>(frame_window);
+    }
+    [[nodiscard]] constexpr std::size_t bytes_per_frame() const { return capture_channels * sample_size; }
+
+    constexpr bool operator==(const DataConfig&) const = default;
 
 public:
     ma_uint32 capture_channels;
@@ -37,38 +86,76 @@ public:
     std::size_t frame_count;
     std::size_t max_frame_count;
     std::size_t frame_window;
+    ma_format format; // of captured samples, they are converted to float only in the analysis stage
     std::size_t frame_size;
     std::size_t frame_max_size;
     std::int64_t frame_window_size;
+    std::size_t sample_size;
 };
 
 struct DataCallback {
-    using ChunkT = std::vector<float>;
-
 public:
-    constexpr explicit DataCallback(const DataConfig& config, sl::exec::executor& sync_executor)
-        : sync_executor_{ sync_executor } {
-        chunk_.reserve(config.frame_max_size);
-    }
+    explicit DataCallback(const DataConfig& config, OverflowPolicy overflow_policy = OverflowPolicy::DROP_OLDEST)
+        : ring_{
+              config.frame_max_size * config.sample_size,
+              config.frame_size * config.sample_size,
+              config.bytes_per_frame(),
+              overflow_policy,
+          },
+          bytes_per_second_{ static_cast<double>(config.bytes_per_frame()) * config.sample_rate } {}
 
-    void operator()(std::span<const float> input);
+    // called from the real-time audio thread with raw interleaved frames: no allocations, no locks, no conversion
+    void operator()(std::span<const std::byte> input);
 
-    [[nodiscard]] bool try_consume(const DataConfig& config, std::invocable<std::span<const float>> auto callable) {
-        if (config.frame_size > chunk_.size()) {
-            return false;
-        }
+    // callable also gets the estimated capture time of the newest frame in the window
+    // false also for a window that got torn by the producer, see Ring::try_consume
+    [[nodiscard]] bool try_consume(
+        const DataConfig& config,
+        std::invocable<std::span<const std::byte>, capture_clock::time_point> auto callable
+    ) {
+        const std::size_t size = config.frame_size * config.sample_size;
+        return ring_.try_consume(
+            size,
+            static_cast<std::size_t>(config.frame_window_size) * config.sample_size,
+            [&](std::span<const std::byte> input, std::uint64_t position) {
+                callable(input, captured_at(position + size));
+            }
+        );
+    }
 
-        const auto begin = chunk_.begin();
-        const auto end = std::next(begin, config.frame_size);
-        callable(std::span<const float>{ begin, end });
-        chunk_.erase(begin, end);
+    // leaves at most keep_windows windows pending, the skipped ones are never copied
+    std::size_t skip_stale(const DataConfig& config, std::size_t keep_windows) {
+        const std::size_t skipped_bytes = ring_.skip_stale(
+            config.frame_size * config.sample_size,
+            static_cast<std::size_t>(config.frame_window_size) * config.sample_size,
+            keep_windows
+        );
+        return skipped_bytes / config.bytes_per_frame();
+    }
 
-        return true;
+    // by overflow of the ring, when the consumer does not keep up
+    [[nodiscard]] std::uint64_t dropped_frames(const DataConfig& config) const {
+        return ring_.dropped() / config.bytes_per_frame();
+    }
+    // by skip_stale
+    [[nodiscard]] std::uint64_t skipped_frames(const DataConfig& config) const {
+        return ring_.skipped() / config.bytes_per_frame();
     }
+    // hard cap on the memory between device and analysis, fixed at construction
+    [[nodiscard]] std::size_t buffer_bytes() const { return ring_.capacity() + ring_.max_read(); }
 
 private:
-    ChunkT chunk_;
-    sl::exec::executor& sync_executor_;
+    // extrapolated from the latest push at the sample rate, device buffering before the callback is not included
+    [[nodiscard]] capture_clock::time_point captured_at(std::uint64_t position) const;
+
+private:
+    Ring ring_;
+    double bytes_per_second_;
+
+    // stream position after the latest push and when it happened, a seqlock so the producer never waits
+    std::atomic<std::uint32_t> stamp_sequence_{ 0 };
+    std::atomic<std::uint64_t> stamp_position_{ 0 };
+    std::atomic<capture_clock::rep> stamp_time_{ 0 };
 };
 
 } // namespace audio
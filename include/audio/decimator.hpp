@@ -0,0 +1,44 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace audio {
+
+// lowpass fir and downsampling by 2, 4 or 8 in one step, as a polyphase filter: input is split into factor phase
+// streams and every phase runs its own short fir, so only the kept outputs are computed, taps / factor MACs per input
+// the passband goes up to 3/4 of the output nyquist, nothing aliases into it by more than -60 dB
+// state is carried across calls, so a stream may be fed in chunks of any multiple of factor up to max_input
+// process does not allocate
+class Decimator {
+public:
+    static constexpr std::size_t max_factor = 8;
+    static constexpr std::size_t taps_per_phase = 16;
+
+    Decimator(std::size_t factor, std::size_t max_input);
+
+    [[nodiscard]] std::size_t factor() const { return factor_; }
+    [[nodiscard]] std::size_t taps() const { return taps_.size(); }
+    [[nodiscard]] float delay() const { return static_cast<float>(taps_.size() - 1) / 2.0f; } // input samples
+
+    // output.size() == input.size() / factor
+    void process(std::span<const float> input, std::span<float> output);
+    void reset();
+
+private:
+    [[nodiscard]] float* phase(std::size_t index) { return phases_.data() + index * phase_stride_; }
+
+private:
+    std::size_t factor_;
+    std::size_t max_input_;
+    std::size_t phase_stride_; // taps_per_phase - 1 samples of state and then max_input / factor new ones
+    std::vector<float> taps_; // phase-major: taps of phase p are prototype taps p, p + factor, p + 2 factor ...
+    std::vector<float> phases_; // factor x phase_stride
+};
+
+} // namespace audio
@@ -0,0 +1,35 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include "audio/data.hpp"
+
+#include <miniaudio/miniaudio.hpp>
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+
+namespace audio {
+
+// planar rows produced from interleaved input of a given channel count:
+// 1 channel: [channel 0]
+// 2 channels: [mid, left, right, side]
+// N channels: [mid, channel 0, ..., channel N - 1]
+[[nodiscard]] std::size_t planar_rows(ma_uint32 channels);
+[[nodiscard]] std::string_view planar_row_name(ma_uint32 channels, std::size_t row); // null-terminated, static
+
+// converts interleaved frames of any miniaudio sample format to float planar rows in a single pass
+// rows.size() == planar_rows(channels), each row holds one sample per input frame
+// a non-empty window has one coefficient per frame and is applied to every row in the same pass
+void deinterleave(
+    std::span<const std::byte> input,
+    ma_format format,
+    ma_uint32 channels,
+    std::span<const std::span<float>> rows,
+    std::span<const float> window = {}
+);
+
+} // namespace audio
@@ -0,0 +1,58 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace audio {
+
+// radix-2 in-place forward (time to freq) unnormalized fft of a fixed power of two size
+// twiddles and bit-reversal permutation are computed once, transform itself does not allocate
+class ComplexFft {
+public:
+    explicit ComplexFft(std::size_t size);
+
+    [[nodiscard]] std::size_t size() const { return size_; }
+
+    void forward(std::span<std::complex<float>> data) const;
+
+private:
+    std::size_t size_;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> bit_reversal_swaps_;
+    std::vector<std::complex<float>> twiddles_;
+};
+
+// real-to-complex fft of a fixed power of two size N, produces only N / 2 + 1 non-redundant bins
+// input is packed into the output buffer and transformed there, so no scratch memory is needed
+class RealFft {
+public:
+    explicit RealFft(std::size_t size);
+
+    [[nodiscard]] std::size_t size() const { return size_; }
+    [[nodiscard]] std::size_t bins() const { return size_ / 2 + 1; }
+
+    void forward(std::span<const float> input, std::span<std::complex<float>> output) const;
+
+private:
+    std::size_t size_;
+    ComplexFft half_;
+    std::vector<std::complex<float>> untangle_twiddles_;
+};
+
+// plans are immutable and shared, switching back to a size that was used before does not recompute twiddles
+class FftPlanCache {
+public:
+    [[nodiscard]] std::shared_ptr<const RealFft> real(std::size_t size);
+
+private:
+    std::vector<std::shared_ptr<const RealFft>> real_; // only a handful of sizes, linear lookup is enough
+};
+
+} // namespace audio
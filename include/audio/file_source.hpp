@@ -0,0 +1,82 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include "audio/data.hpp"
+#include "audio/mapped_file.hpp"
+
+#include <miniaudio/miniaudio.hpp>
+#include <sl/meta/monad/result.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace audio {
+
+// wav, flac or mp3 decoded straight out of a memory mapping, only the part being decoded is ever resident
+// output is in the native format of the file, conversion happens in the analysis stage like for devices
+class FileSource {
+public:
+    static sl::meta::result<std::unique_ptr<FileSource>, std::string> open(const std::filesystem::path& path);
+
+    [[nodiscard]] NativeFormat native_format() const;
+    [[nodiscard]] ma_uint64 length() const { return length_; } // in frames, 0 if the decoder can not tell
+
+    // returns frames read, less than frame_count only at the end of the file
+    ma_uint64 read(std::span<std::byte> output, ma_uint64 frame_count);
+    bool seek(ma_uint64 frame);
+    [[nodiscard]] ma_uint64 cursor() const; // frame read next
+
+private:
+    FileSource(MappedFile file, ma::decoder_uptr decoder);
+
+private:
+    MappedFile file_;
+    ma::decoder_uptr decoder_; // reads from file_, so it goes after it
+    ma_uint64 length_ = 0;
+};
+
+// plays FileSource into a callback from its own thread at speed times real time, loops at the end of the file
+// starts at the cursor of the source, so a source seeked beforehand resumes from there
+// callback must outlive the device
+class FileDevice {
+public:
+    FileDevice(
+        const DataConfig& data_config,
+        std::unique_ptr<FileSource> source,
+        DataCallback& callback,
+        ma_uint32 period_frames = 480,
+        double speed = 1.0
+    );
+
+    // applied by the device thread before its next period
+    void seek(ma_uint64 frame) { seek_request_.store(frame, std::memory_order::relaxed); }
+
+    [[nodiscard]] ma_uint64 position() const { return position_.load(std::memory_order::relaxed); }
+    [[nodiscard]] ma_uint64 length() const { return source_->length(); }
+    [[nodiscard]] std::uint32_t sample_rate() const { return sample_rate_; }
+
+private:
+    void run(std::stop_token stop_token, DataCallback& callback, double speed);
+
+private:
+    static constexpr ma_uint64 no_seek = ~ma_uint64{ 0 };
+
+    std::unique_ptr<FileSource> source_;
+    ma_uint32 sample_rate_;
+    ma_uint32 period_frames_;
+    std::size_t bytes_per_frame_;
+    std::vector<std::byte> period_;
+    std::atomic<ma_uint64> seek_request_{ no_seek };
+    std::atomic<ma_uint64> position_{ 0 };
+    std::jthread thread_; // last, so it is joined before anything it uses is destroyed
+};
+
+} // namespace audio
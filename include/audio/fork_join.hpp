@@ -0,0 +1,52 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include "audio/ring.hpp"
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace audio {
+
+// persistent threads for short data-parallel batches, dispatching a batch does not allocate
+class ForkJoin {
+public:
+    explicit ForkJoin(std::size_t threads);
+    ~ForkJoin();
+
+    ForkJoin(const ForkJoin&) = delete;
+    ForkJoin& operator=(const ForkJoin&) = delete;
+
+    // calls task(i) for every i in [0, size) across the pool and the calling thread, returns once all are done
+    template <std::invocable<std::size_t> Task>
+    void run(std::size_t size, Task& task) {
+        run_erased(size, [](void* context, std::size_t index) { (*static_cast<Task*>(context))(index); }, &task);
+    }
+
+private:
+    using erased_task = void (*)(void*, std::size_t);
+
+    void run_erased(std::size_t size, erased_task task, void* context);
+    void work();
+    void worker_loop(std::stop_token stop_token);
+
+private:
+    erased_task task_ = nullptr;
+    void* context_ = nullptr;
+    std::size_t size_ = 0;
+
+    alignas(cache_line_size) std::atomic<std::size_t> next_{ 0 };
+    alignas(cache_line_size) std::atomic<std::size_t> acknowledged_{ 0 };
+    alignas(cache_line_size) std::atomic<std::uint64_t> generation_{ 0 };
+
+    std::vector<std::jthread> threads_; // last, so they are joined before anything they use is destroyed
+};
+
+} // namespace audio
@@ -0,0 +1,38 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include <sl/meta/monad/result.hpp>
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <system_error>
+
+namespace audio {
+
+// read-only memory mapping of a whole file, pages are brought in by the os only when they are touched
+class MappedFile {
+public:
+    static sl::meta::result<MappedFile, std::error_code> open(const std::filesystem::path& path);
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    [[nodiscard]] std::span<const std::byte> data() const { return { data_, size_ }; }
+
+private:
+    MappedFile(const std::byte* data, std::size_t size) : data_{ data }, size_{ size } {}
+    void unmap();
+
+private:
+    const std::byte* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+} // namespace audio
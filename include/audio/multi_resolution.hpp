@@ -0,0 +1,77 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include "audio/data.hpp"
+#include "audio/decimator.hpp"
+#include "audio/fft.hpp"
+#include "audio/window.hpp"
+
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace audio {
+
+struct MultiResolutionConfig {
+    // level k analyses the input decimated by 2^k, clamped to what the window and Decimator::max_factor allow
+    std::size_t levels = 4;
+    WindowFunction window_function = WindowFunction::HANN; // of every level
+
+    constexpr bool operator==(const MultiResolutionConfig&) const = default;
+};
+
+// one short fft of S = frame_count / 2^(levels - 1) frames run over the input decimated by 1, 2, 4, 8
+// level k sees a 2^k times longer window with 2^k times finer bins and is recomputed 2^k times less often,
+// so highs follow transients at the short window while lows keep the resolution of the full frame_count window
+// every level covers one octave below the previous one, those are stitched onto the frame_count / 2 linear bins,
+// so the spectrum looks like the one of a single frame_count fft to whatever consumes it
+// rows are independent, different rows may be pushed and analysed from different threads
+class MultiResolution {
+public:
+    MultiResolution(
+        const DataConfig& config,
+        const MultiResolutionConfig& multi_resolution_config,
+        FftPlanCache& fft_plans
+    );
+
+    [[nodiscard]] std::size_t levels() const { return levels_; }
+    [[nodiscard]] std::size_t fft_size() const { return fft_->size(); }
+    [[nodiscard]] std::size_t hop() const { return hop_; } // frames per push, at the full rate
+    [[nodiscard]] std::size_t bins() const { return bins_; }
+
+    // one hop of a planar row, every hop has to be pushed in order since the levels keep their own history
+    void push(std::size_t row, std::span<const float> input);
+
+    // recomputes the levels that have collected a hop of their own samples since their last fft, then stitches
+    // returns the sum of (normalized + 1) / 2 over the stitched row, like normalized_log_spectrum does
+    float analyse(std::size_t row, std::span<float> normalized);
+
+private:
+    struct Lane { // one level of one row
+        std::optional<Decimator> decimator; // from the full rate, none for level 0
+        std::vector<float> history; // latest S samples at the rate of the level, oldest first
+        std::vector<float> windowed; // fft input, empty without a window
+        std::vector<std::complex<float>> freq_domain; // S / 2 + 1
+        std::vector<float> normalized; // S / 2, kept between ffts, so slow levels are stitched as they were
+        std::size_t pending = 0; // samples since the last fft
+    };
+
+    [[nodiscard]] Lane& lane(std::size_t row, std::size_t level) { return lanes_[row * levels_ + level]; }
+
+private:
+    std::size_t levels_;
+    std::size_t hop_;
+    std::size_t bins_;
+    std::shared_ptr<const RealFft> fft_;
+    Window window_; // S, the same at every level
+    float log_gain_; // ln (N / S) / ln N, lifts the S point magnitudes of every level to those of an N point fft
+    std::vector<Lane> lanes_; // rows x levels
+};
+
+} // namespace audio
@@ -0,0 +1,64 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include "audio/data.hpp"
+#include "audio/fft.hpp"
+
+#include <sl/meta/monad/result.hpp>
+#include <sl/meta/type/unit.hpp>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace audio {
+
+// layout of a spectra file: header, then one record per hop
+// record: sound level of the first row in [0, 1], then rows x bins of normalized spectrum, all floats
+// bins are the frame_count / 2 linear fft bins, not bands, unlike a RecordedFrame the scale is left to the reader
+struct SpectraHeader {
+    static constexpr std::array<char, 4> expected_magic{ 'S', 'M', 'V', 'S' };
+    static constexpr std::uint32_t expected_version = 1;
+
+    std::array<char, 4> magic = expected_magic;
+    std::uint32_t version = expected_version;
+    std::uint32_t sample_rate;
+    std::uint32_t rows;
+    std::uint32_t bins;
+    std::uint32_t frame_window;
+    std::uint64_t hops;
+
+    [[nodiscard]] std::size_t record_size() const { return (1 + std::size_t{ rows } * bins) * sizeof(float); }
+    [[nodiscard]] std::size_t file_size() const { return sizeof(SpectraHeader) + hops * record_size(); }
+};
+
+// one input file analysed into one spectra file, hops are independent so any range can be analysed on its own
+struct OfflineFile {
+    std::filesystem::path input;
+    std::filesystem::path output;
+    DataConfig config; // in the native format of input
+    SpectraHeader header;
+};
+
+// opens input once for its format and length, then creates output at its full size with the header written
+sl::meta::result<OfflineFile, std::string> offline_prepare(
+    const std::filesystem::path& input,
+    const std::filesystem::path& output,
+    const DataConfig& analysis_config
+);
+
+// analyses hops [first_hop, last_hop) and writes their records in place, safe to run concurrently on disjoint ranges
+// a range decodes every window it owns in full, so the overlap at a seam is decoded by both neighbouring ranges
+sl::meta::result<sl::meta::unit, std::string> offline_analyse(
+    const OfflineFile& file,
+    std::uint64_t first_hop,
+    std::uint64_t last_hop,
+    std::shared_ptr<const RealFft> fft
+);
+
+} // namespace audio
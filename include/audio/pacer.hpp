@@ -0,0 +1,41 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+namespace audio {
+
+// sleeps out one period of frames at speed times real time, speed 0 never sleeps
+// deadlines are accumulated rather than slept relative to now, so the rate does not drift
+class Pacer {
+public:
+    using clock = std::chrono::steady_clock;
+
+    Pacer(std::size_t period_frames, std::uint32_t sample_rate, double speed)
+        : is_paced_{ speed > 0.0 }, //
+          period_duration_{ is_paced_ ? std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>{
+                                            static_cast<double>(period_frames) / (sample_rate * speed) })
+                                      : clock::duration::zero() },
+          deadline_{ clock::now() } {}
+
+    void wait() {
+        if (!is_paced_) {
+            return;
+        }
+        deadline_ += period_duration_;
+        std::this_thread::sleep_until(deadline_);
+    }
+
+private:
+    bool is_paced_;
+    clock::duration period_duration_;
+    clock::time_point deadline_;
+};
+
+} // namespace audio
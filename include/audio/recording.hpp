@@ -0,0 +1,127 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include "audio/mapped_file.hpp"
+
+#include <sl/meta/monad/result.hpp>
+#include <sl/meta/type/unit.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace audio {
+
+// width of a quantized spectrum value, values in [-1, 1] are mapped onto the whole unsigned range
+enum class Quantization : std::uint32_t {
+    U8 = 1,
+    U16 = 2,
+};
+
+// layout of a recording: header, frames, keyframe index, all fixed width integers are little-endian
+// header: magic, then the u32 and u64 fields below in order, encoded_size bytes
+// frame: varint timestamp in ns, u16 sound level, then rows x bins values
+// every keyframe_interval-th frame is a keyframe with an absolute timestamp and fixed width values,
+// others store the timestamp and values as (zigzag) varint deltas to the previous frame
+// index: (byte offset, timestamp in ns) as u64 pairs for every keyframe
+struct RecordingHeader {
+    static constexpr std::array<char, 4> expected_magic{ 'S', 'M', 'V', 'R' };
+    static constexpr std::uint32_t expected_version = 1;
+    static constexpr std::size_t encoded_size = 40;
+
+    std::array<char, 4> magic = expected_magic;
+    std::uint32_t version = expected_version;
+    std::uint32_t rows;
+    std::uint32_t bins; // bands per row, as published
+    Quantization quantization;
+    std::uint32_t keyframe_interval;
+    std::uint64_t frame_count = 0; // written on close
+    std::uint64_t index_offset = 0; // written on close
+
+    [[nodiscard]] std::size_t values() const { return std::size_t{ rows } * bins; }
+};
+
+struct RecordedFrame {
+    std::chrono::nanoseconds timestamp{};
+    float sound_level = 0.0f;
+    std::vector<float> normalized; // rows x bands, as it was passed to RenderState, see SpectraHeader for linear bins
+};
+
+// appends frames to a recording, the index and the final header are written on close
+// write does not allocate once the first frame has been encoded, unless the keyframe index outgrows what is reserved,
+// which is reserved_keyframes up front and then grows geometrically
+class SpectrumRecorder {
+public:
+    static constexpr std::size_t reserved_keyframes = 1024; // 65536 frames at the default interval
+
+
+    static sl::meta::result<std::unique_ptr<SpectrumRecorder>, std::string> create(
+        const std::filesystem::path& path,
+        std::size_t rows,
+        std::size_t bins,
+        Quantization quantization = Quantization::U8,
+        std::uint32_t keyframe_interval = 64
+    );
+    // closes if it was not, a failure can only be logged then
+    ~SpectrumRecorder();
+
+    void write(std::chrono::nanoseconds timestamp, float sound_level, std::span<const float> normalized);
+    // writes the index and the final header, also reports a failure of any write before
+    sl::meta::result<sl::meta::unit, std::string> close();
+
+private:
+    SpectrumRecorder(std::filesystem::path path, std::ofstream stream, const RecordingHeader& header);
+
+private:
+    std::filesystem::path path_;
+    std::ofstream stream_;
+    bool is_closed_ = false;
+    RecordingHeader header_;
+    std::uint64_t offset_ = RecordingHeader::encoded_size;
+    std::chrono::nanoseconds previous_timestamp_{};
+    std::vector<std::uint16_t> previous_;
+    std::vector<std::uint16_t> current_;
+    std::vector<std::byte> encoded_;
+    std::vector<std::array<std::uint64_t, 2>> index_;
+};
+
+// reads a finished recording straight out of a memory mapping
+class SpectrumRecording {
+public:
+    static sl::meta::result<SpectrumRecording, std::string> open(const std::filesystem::path& path);
+
+    [[nodiscard]] const RecordingHeader& header() const { return header_; }
+    [[nodiscard]] std::uint64_t position() const { return position_; } // index of the frame next returns
+
+    // decodes the frame at position and advances, false past the last frame
+    // a truncated or corrupt frame is an error and leaves the position where it was
+    sl::meta::result<bool, std::string> next(RecordedFrame& frame);
+    // jumps to the closest preceding keyframe and decodes forward up to frame_index
+    sl::meta::result<sl::meta::unit, std::string> seek(std::uint64_t frame_index);
+
+private:
+    SpectrumRecording(MappedFile file, const RecordingHeader& header);
+
+private:
+    MappedFile file_;
+    RecordingHeader header_;
+    std::span<const std::byte> index_;
+    std::uint64_t position_ = 0;
+    std::size_t offset_ = RecordingHeader::encoded_size;
+    std::chrono::nanoseconds previous_timestamp_{};
+    std::vector<std::uint16_t> previous_;
+    std::vector<std::uint16_t> decoded_; // of the frame in progress, becomes previous_ once it is complete
+    RecordedFrame scratch_;
+};
+
+} // namespace audio
@@ -0,0 +1,88 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <utility>
+
+namespace audio {
+
+// not std::hardware_destructive_interference_size, it is not ABI-stable and gcc warns about that
+inline constexpr std::size_t cache_line_size = 64;
+
+enum class OverflowPolicy {
+    DROP_OLDEST = 0,
+    DROP_NEWEST = 1,
+};
+
+// Ring of raw sample bytes for one producer and one consumer, written and read in whole frames of granularity bytes.
+// Storage is mirrored past the end by max_read bytes, so every read of up to max_read bytes is contiguous.
+// With DROP_OLDEST the read position is shared: the producer reclaims unread frames by moving it forward
+// before overwriting them, so a read that the producer has reclaimed in the meantime may be torn,
+// the consumer notices that on commit, discards the read and the reclaimed frames are accounted as dropped.
+// With DROP_NEWEST only the consumer moves the read position and reads are never torn.
+class Ring {
+public:
+    Ring(std::size_t min_capacity, std::size_t max_read, std::size_t granularity, OverflowPolicy overflow_policy);
+
+    // producer side, never allocates nor blocks
+    // returns the stream position past the last written byte, positions count every byte ever written
+    std::uint64_t push(std::span<const std::byte> input);
+
+    // consumer side, callable also gets the stream position of the first byte
+    // returns false if there was not enough to read, or if the producer has reclaimed the bytes while callable was
+    // reading them, then whatever callable made out of them has to be discarded
+    template <std::invocable<std::span<const std::byte>, std::uint64_t> Callable>
+    [[nodiscard]] bool try_consume(std::size_t size, std::size_t advance, Callable&& callable) {
+        const auto maybe_read = try_acquire(size);
+        if (!maybe_read.has_value()) {
+            return false;
+        }
+        std::uint64_t read = *maybe_read;
+        std::forward<Callable>(callable)(std::span<const std::byte>{ data_.get() + (read & mask_), size }, read);
+        // fails only if producer has reclaimed these bytes, they are already accounted for as dropped
+        return read_.value.compare_exchange_strong(read, read + advance, std::memory_order::release);
+    }
+
+    // consumer side, moves the read position by whole advances so that at most keep reads of size remain
+    // returns the number of skipped bytes, accounted as skipped rather than dropped
+    std::size_t skip_stale(std::size_t size, std::size_t advance, std::size_t keep);
+
+    [[nodiscard]] std::size_t capacity() const { return capacity_; }
+    [[nodiscard]] std::size_t max_read() const { return max_read_; }
+    [[nodiscard]] std::size_t available() const;
+    [[nodiscard]] std::uint64_t dropped() const { return dropped_.value.load(std::memory_order::relaxed); }
+    [[nodiscard]] std::uint64_t skipped() const { return skipped_.value.load(std::memory_order::relaxed); }
+
+private:
+    [[nodiscard]] std::optional<std::uint64_t> try_acquire(std::size_t size) const;
+    [[nodiscard]] std::size_t floor_to_granularity(std::size_t size) const { return size - size % granularity_; }
+    void write_at(std::size_t index, std::span<const std::byte> input);
+
+private:
+    struct alignas(cache_line_size) Counter {
+        std::atomic<std::uint64_t> value{ 0 };
+    };
+
+    std::size_t capacity_;
+    std::size_t mask_;
+    std::size_t max_read_;
+    std::size_t granularity_;
+    OverflowPolicy overflow_policy_;
+    std::unique_ptr<std::byte[]> data_;
+
+    Counter write_;
+    Counter read_;
+    Counter dropped_;
+    Counter skipped_;
+};
+
+} // namespace audio
@@ -0,0 +1,17 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include <complex>
+#include <span>
+
+namespace audio {
+
+// fused single pass over the fft output:
+// output[k] = ln |X[k]| / ln N for k in [0, output.size()), where N is the fft size
+// returns sum of (output[k] + 1) / 2, which is what sound level is derived from
+float normalized_log_spectrum(std::span<const std::complex<float>> bins, std::size_t fft_size, std::span<float> output);
+
+} // namespace audio
@@ -0,0 +1,63 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include "audio/data.hpp"
+
+#include <miniaudio/miniaudio.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace audio {
+
+struct SyntheticConfig {
+    ma_waveform_type waveform = ma_waveform_type_sine;
+    double amplitude = 0.2;
+    double frequency = 220.0;
+    ma_uint32 period_frames = 480; // frames per callback, like a backend period
+    double speed = 1.0; // multiple of real time, 0 means as fast as possible
+};
+
+// in-process stand-in for a capture device, generates interleaved frames in the format of DataConfig
+// output is deterministic, so the same sequence of feed calls always produces the same samples
+class SyntheticSource {
+public:
+    SyntheticSource(const DataConfig& data_config, const SyntheticConfig& config);
+
+    [[nodiscard]] const SyntheticConfig& config() const { return config_; }
+
+    // pushes frame_count frames into callback in period_frames sized chunks, same path a device callback takes
+    void feed(DataCallback& callback, std::size_t frame_count);
+
+private:
+    SyntheticConfig config_;
+    std::size_t bytes_per_frame_;
+    ma_waveform waveform_{};
+    std::vector<std::byte> period_;
+};
+
+// drives SyntheticSource from its own thread at config.speed times real time
+// callback must outlive the device
+class SyntheticDevice {
+public:
+    SyntheticDevice(const DataConfig& data_config, const SyntheticConfig& config, DataCallback& callback);
+
+    [[nodiscard]] std::uint64_t generated_frames() const { return generated_frames_.load(std::memory_order::relaxed); }
+
+private:
+    void run(std::stop_token stop_token, DataCallback& callback);
+
+private:
+    SyntheticSource source_;
+    ma_uint32 sample_rate_;
+    std::atomic<std::uint64_t> generated_frames_{ 0 };
+    std::jthread thread_; // last, so it is joined before anything it uses is destroyed
+};
+
+} // namespace audio
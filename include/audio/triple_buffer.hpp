@@ -0,0 +1,51 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include "audio/ring.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace audio {
+
+// Lock-free single-writer/single-reader handoff of the latest value.
+// Writer fills back() and publishes it, reader picks up the latest published value and keeps it stable in front(),
+// neither side ever waits for the other and older unread values are simply overwritten.
+template <typename T>
+class TripleBuffer {
+    static constexpr std::uint8_t index_mask = 0b011;
+    static constexpr std::uint8_t dirty_bit = 0b100;
+
+public:
+    explicit TripleBuffer(const T& initial) : slots_{ initial, initial, initial } {}
+
+    // writer side
+    [[nodiscard]] T& back() { return slots_[back_]; }
+    void publish() { back_ = middle_.value.exchange(back_ | dirty_bit, std::memory_order::acq_rel) & index_mask; }
+
+    // reader side, returns true if front() has changed
+    bool update() {
+        if ((middle_.value.load(std::memory_order::relaxed) & dirty_bit) == 0) {
+            return false;
+        }
+        front_ = middle_.value.exchange(front_, std::memory_order::acq_rel) & index_mask;
+        return true;
+    }
+    [[nodiscard]] const T& front() const { return slots_[front_]; }
+
+private:
+    struct alignas(cache_line_size) Middle {
+        std::atomic<std::uint8_t> value{ 1 };
+    };
+
+    std::array<T, 3> slots_;
+    alignas(cache_line_size) std::uint8_t back_ = 0;
+    Middle middle_;
+    alignas(cache_line_size) std::uint8_t front_ = 2;
+};
+
+} // namespace audio
@@ -0,0 +1,49 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace audio {
+
+enum class WindowFunction {
+    RECTANGULAR = 0, // no window, for transforms that window by themselves like constant-Q
+    HANN = 1,
+    HAMMING = 2,
+    BLACKMAN_HARRIS = 3, // 4-term, -92 dB sidelobes
+    FLAT_TOP = 4, // widest main lobe, but peaks read the same level wherever they fall between bins
+    ENUM_END,
+};
+
+// periodic window of a power of two size, coefficients are scaled to unit mean, so a sine reads the same level
+// with every window, only leakage and main lobe width change
+// sizes from 64 to 8192 point into tables generated at compile time, other sizes are computed once on construction
+class Window {
+public:
+    static constexpr std::size_t min_table_size = 64;
+    static constexpr std::size_t max_table_size = 8192;
+
+    Window(WindowFunction function, std::size_t size);
+
+    Window(const Window&) = delete;
+    Window& operator=(const Window&) = delete;
+    Window(Window&&) noexcept = default;
+    Window& operator=(Window&&) noexcept = default;
+
+    [[nodiscard]] WindowFunction function() const { return function_; }
+    [[nodiscard]] std::size_t size() const { return size_; }
+    // empty for RECTANGULAR, which skips the multiplication altogether
+    [[nodiscard]] std::span<const float> coefficients() const { return coefficients_; }
+
+private:
+    WindowFunction function_;
+    std::size_t size_;
+    std::vector<float> computed_; // only for sizes without a table
+    std::span<const float> coefficients_;
+};
+
+} // namespace audio
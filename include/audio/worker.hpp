@@ -0,0 +1,39 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include "audio/analyzer.hpp"
+#include "audio/data.hpp"
+#include "audio/triple_buffer.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace audio {
+
+// runs Analyzer on a dedicated thread, finished spectra are handed over through a triple buffer
+// callback and analyzer must outlive the worker and must not be touched by anyone else while it runs
+class AnalysisWorker {
+public:
+    AnalysisWorker(const DataConfig& config, DataCallback& callback, Analyzer& analyzer);
+
+    // picks up the latest published spectrum, it stays valid until the next call
+    [[nodiscard]] const Spectrum& latest();
+
+    // next published spectrum will carry a snapshot of time and frequency domain
+    void request_snapshot() { snapshot_requested_.store(true, std::memory_order::relaxed); }
+
+private:
+    void run(std::stop_token stop_token, DataCallback& callback, Analyzer& analyzer);
+
+private:
+    TripleBuffer<Spectrum> spectra_;
+    std::chrono::nanoseconds poll_period_;
+    std::atomic<bool> snapshot_requested_{ false };
+    std::jthread thread_; // last, so it is joined before anything it uses is destroyed
+};
+
+} // namespace audio
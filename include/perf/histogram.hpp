@@ -0,0 +1,80 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace perf {
+
+// log-linear buckets over nanoseconds: every power of two is split into 2^sub_bucket_bits linear steps
+// record is a couple of relaxed atomics, it neither allocates nor blocks, so any thread may call it
+class Histogram {
+public:
+    static constexpr std::size_t sub_bucket_bits = 2;
+    static constexpr std::size_t bucket_count = 64 << sub_bucket_bits;
+
+    struct Summary {
+        std::uint64_t count;
+        std::chrono::nanoseconds p50;
+        std::chrono::nanoseconds p99;
+        std::chrono::nanoseconds max;
+    };
+
+public:
+    void record(std::chrono::nanoseconds duration);
+    void reset();
+
+    // percentiles are upper bounds of their bucket, so within 25% of the real value
+    [[nodiscard]] Summary summary() const;
+
+private:
+    [[nodiscard]] static std::size_t bucket_of(std::uint64_t value);
+    [[nodiscard]] static std::uint64_t bucket_upper_bound(std::size_t bucket);
+
+private:
+    std::array<std::atomic<std::uint64_t>, bucket_count> buckets_{};
+    std::atomic<std::uint64_t> max_{ 0 };
+};
+
+enum class Stage {
+    INGESTION = 0, // DataCallback, on the real-time audio thread
+    DEINTERLEAVE = 1,
+    DECIMATE = 2, // all planar rows, only in multi-resolution mode
+    FFT = 3, // per planar row
+    CONSTANT_Q = 4, // per planar row, only in constant-Q mode
+    SPECTRUM = 5, // magnitude, log, normalization and level, per planar row
+    BANDS = 6, // bins to bands, all planar rows
+    TBO_UPLOAD = 7,
+    DRAW = 8, // cpu side of submitting the draw call
+    ENUM_END,
+};
+
+[[nodiscard]] std::string_view stage_name(Stage stage);
+[[nodiscard]] Histogram& histogram(Stage stage);
+
+// end to end: from capture of the newest analysed frame until its spectrum is written into the tbo
+[[nodiscard]] Histogram& capture_latency();
+
+class ScopedTimer {
+public:
+    using clock = std::chrono::steady_clock;
+
+    explicit ScopedTimer(Stage stage) : histogram_{ histogram(stage) }, start_{ clock::now() } {}
+    ~ScopedTimer() { histogram_.record(clock::now() - start_); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram& histogram_;
+    clock::time_point start_;
+};
+
+} // namespace perf
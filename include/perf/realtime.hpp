@@ -0,0 +1,44 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include <cstdint>
+
+// checks that real-time audio threads neither allocate nor block
+// counting is done by src/perf/realtime_interpose.cpp, which replaces the global allocator and interposes pthread locks
+// it is only linked into tests and into the app built with SMV_REALTIME_CHECK, otherwise nothing is counted
+namespace perf::realtime {
+
+struct Violations {
+    std::uint64_t allocations = 0;
+    std::uint64_t deallocations = 0;
+    std::uint64_t blocking_calls = 0;
+
+    [[nodiscard]] std::uint64_t total() const { return allocations + deallocations + blocking_calls; }
+};
+
+// marks the calling thread as real-time while alive, nests
+class Section {
+public:
+    Section();
+    ~Section();
+
+    Section(const Section&) = delete;
+    Section& operator=(const Section&) = delete;
+};
+
+[[nodiscard]] bool is_realtime_thread();
+[[nodiscard]] bool is_checked(); // whether the interposer is linked in
+
+[[nodiscard]] Violations violations();
+void reset();
+
+// for the interposer, count only when called on a real-time thread
+void mark_checked();
+void on_allocation();
+void on_deallocation();
+void on_blocking_call();
+
+} // namespace perf::realtime
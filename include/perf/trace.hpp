@@ -0,0 +1,50 @@
+//
+// Created by usatiynyan.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+// opt-in chrome trace-event recording, open the dump in chrome://tracing or ui.perfetto.dev
+// every thread writes begin/end events into its own buffer, so recording never locks,
+// buffers are allocated by enable and claimed with atomics only, so real-time threads can trace from their first call
+// a released buffer goes to the next thread of the same name, which continues its track
+// a thread that runs out of buffer drops its further events, the dump tells how many
+namespace perf::trace {
+
+struct Options {
+    std::size_t max_threads = 16; // buffers alive at once
+    std::size_t events_per_thread = std::size_t{ 1 } << 18;
+};
+
+// can only be done once
+void enable(std::filesystem::path output, const Options& options = {});
+// enables if SMV_TRACE is set, its value is the output path
+void enable_from_environment();
+[[nodiscard]] bool is_enabled();
+
+// names must be string literals or otherwise outlive the trace
+void name_thread(const char* name); // first name given to a thread sticks
+// gives the buffers of threads of this name up, call it once they have stopped recording, from any thread
+void release_thread(const char* name);
+void begin(const char* name);
+void end(const char* name);
+
+// writes everything recorded so far, can be called repeatedly, does nothing if tracing is disabled
+void dump();
+
+class Scope {
+public:
+    explicit Scope(const char* name) : name_{ name } { begin(name_); }
+    ~Scope() { end(name_); }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* name_;
+};
+
+} // namespace perf::trace
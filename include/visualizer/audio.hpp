@@ -4,59 +4,162 @@
 
 #pragma once
 
+#include "audio/analyzer.hpp"
+#include "audio/bands.hpp"
 #include "audio/context.hpp"
 #include "audio/data.hpp"
+#include "audio/file_source.hpp"
+#include "audio/recording.hpp"
+#include "audio/synthetic.hpp"
+#include "audio/worker.hpp"
 
 #include <sl/game.hpp>
 #include <sl/gfx.hpp>
 
+#include <array>
+#include <chrono>
 #include <complex>
+#include <filesystem>
+#include <optional>
 
 namespace visualizer {
 
+enum class SourceType {
+    CAPTURE = 0,
+    LOOPBACK = 1,
+    SYNTHETIC = 2, // generated in-process, needs no sound hardware
+    FILE = 3, // decoded from a memory-mapped file at real-time pace
+    REPLAY = 4, // recorded spectra, capture and analysis are skipped entirely
+};
+
+enum class SpectrumMode {
+    FFT = 0, // linear fft bins grouped into bands
+    MULTI_RESOLUTION = 1, // same bins and bands, lows from decimated input, highs from a shorter window
+    CONSTANT_Q = 2,
+    VARIABLE_Q = 3, // constant-Q with the low bins widened along the bandwidth of hearing
+    ENUM_END,
+};
+
 struct AudioState {
+    audio::DataConfig config; // adapted to the native format of the opened device and to analysis_controls
     audio::Context context;
+    audio::FftPlanCache fft_plans;
     std::unique_ptr<audio::DataCallback> callback;
+    std::unique_ptr<audio::Analyzer> analyzer;
+    std::unique_ptr<audio::AnalysisWorker> worker; // while set, analyzer and callback belong to the worker thread
+    audio::BandMap band_map; // analyzer bins to the bands passed to RenderState, unused for constant-Q
 
     struct Intermediate {
-        // TODO(@usatiynyan): time_domain_input for multiple channels
-        std::vector<std::complex<float>> time_domain;
-        std::vector<std::complex<float>> freq_domain;
+        audio::Spectrum spectrum; // analyzer writes here directly when there is no worker
+        std::uint64_t generation = 0; // of the last spectrum passed to RenderState
+        float sound_level = 0.0f;
+        bool snapshot_requested = false;
+        std::vector<float> bands; // rows x band_map.bands(), as passed to RenderState unless in constant-Q
+
+        // lazy, computed from the spectrum snapshot only when audio_overlay plots them
         std::vector<std::complex<float>> half_freq_domain;
         std::vector<float> abs_half_freq_domain;
         std::vector<float> log_abs_half_freq_domain;
-        std::vector<float> normalized_freq_domain_output;
-        float sound_level = 0.0f;
+        std::uint64_t debug_generation = 0;
     } intermediate;
 
     struct Device {
         sl::meta::result<ma::device_uptr, ma_result> handle;
         sl::meta::result<sl::meta::defer<>, ma_result> running;
+        std::unique_ptr<audio::SyntheticDevice> synthetic; // instead of handle for SourceType::SYNTHETIC
+        std::unique_ptr<audio::FileDevice> file; // instead of handle for SourceType::FILE
+        ma_uint64 file_position = 0; // where file was closed, reopening the same file continues from there
     } device;
 
+    // spectra as they were passed to RenderState, sound level included
+    struct Recording {
+        std::unique_ptr<audio::SpectrumRecorder> recorder;
+        std::chrono::nanoseconds elapsed{};
+    } recording;
+
+    struct Replay {
+        std::optional<audio::SpectrumRecording> recording;
+        audio::RecordedFrame current; // last frame passed to RenderState
+        audio::RecordedFrame pending; // decoded ahead, passed once elapsed reaches its timestamp
+        std::chrono::nanoseconds elapsed{};
+    } replay;
+
     struct DeviceControls {
-        sl::meta::dirty<ma_device_type> type;
+        sl::meta::dirty<SourceType> type;
         sl::meta::dirty<std::size_t> index;
+        sl::meta::dirty<std::filesystem::path> file;
+        std::array<char, 1024> file_input{}; // edited by imgui, becomes file on "open"
     } device_controls;
+
+    struct AnalysisControls {
+        sl::meta::dirty<bool> use_worker;
+        sl::meta::dirty<std::size_t> frame_count; // fft size
+        sl::meta::dirty<std::size_t> frame_window; // hop
+        sl::meta::dirty<std::size_t> max_frame_count; // buffered between device and analysis
+        sl::meta::dirty<SpectrumMode> spectrum_mode;
+        sl::meta::dirty<audio::WindowFunction> window_function;
+        sl::meta::dirty<audio::LatencyPolicy> latency_policy; // survives reconfiguration
+        sl::meta::dirty<audio::BandConfig> band_config; // survives reconfiguration
+    } analysis_controls;
+
+    struct RecordingControls {
+        sl::meta::dirty<bool> record;
+    } recording_controls;
 };
 
 sl::exec::async<entt::entity> create_audio_entity(
-    sl::game::engine_context& e_ctx,
     sl::ecs::layer& layer,
     const audio::DataConfig& config,
     entt::entity render_entity
 );
 
 void audio_update_process(
-    const audio::DataConfig& config,
     sl::ecs::layer& layer,
     entt::entity render_entity,
     AudioState& audio_state,
     sl::game::time_point time_point
 );
 
-void audio_update_device(const audio::DataConfig& config, AudioState& audio_state);
+// feeds RenderState from the replayed recording at the pace it was recorded, loops at the end
+void audio_update_replay(
+    sl::ecs::layer& layer,
+    entt::entity render_entity,
+    AudioState& audio_state,
+    sl::game::time_point time_point
+);
+
+// either the worker's latest published spectrum or the one analysed in place on this thread
+const audio::Spectrum& audio_latest_spectrum(AudioState& audio_state);
+
+// only used for plotting in audio_overlay, production path needs nothing but normalized output and sound level
+// does nothing if intermediates are already up to date with the latest spectrum snapshot
+void audio_update_debug_intermediates(const audio::Spectrum& spectrum, AudioState::Intermediate& intermediate);
+
+void audio_update_analysis(AudioState& audio_state);
+
+// starts or stops recording into recording-<date>.smvr in the working directory
+void audio_update_recording(AudioState& audio_state);
+
+// stops the device and the worker, then rebuilds everything that is sized from config, fft plans come from the cache
+// happens once per change, nothing is reallocated per frame
+void audio_reconfigure(AudioState& audio_state, const audio::DataConfig& config);
+
+// stops and releases whatever source is currently feeding the callback
+void audio_close_device(AudioState& audio_state);
+
+// reconfigures for a source that delivers native_format, does nothing if config already matches it
+void audio_adapt_to_native_format(AudioState& audio_state, const audio::NativeFormat& native_format);
+
+void audio_update_device(AudioState& audio_state);
+
+void audio_overlay(
+    sl::ecs::layer& layer,
+    sl::gfx::imgui_frame&,
+    entt::entity entity,
+    entt::entity render_entity
+);
 
-void audio_overlay(const audio::DataConfig& config, sl::ecs::layer& layer, sl::gfx::imgui_frame&, entt::entity entity);
+// p50, p99 and max of every perf::Stage and of the capture latency
+void performance_overlay(sl::gfx::imgui_frame& imgui_frame);
 
 } // namespace visualizer
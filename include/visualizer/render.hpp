@@ -34,7 +34,10 @@ enum class DrawMode : GLuint {
 };
 
 struct RenderState {
-    sl::meta::dirty<std::vector<float>> normalized_freq_proc_output;
+    sl::meta::dirty<std::vector<float>> normalized_freq_proc_output; // rows x bands
+    sl::meta::dirty<std::chrono::steady_clock::time_point> captured_at; // of normalized_freq_proc_output, if live
+    sl::meta::dirty<GLuint> nfdo_row;
+    sl::meta::dirty<GLuint> nfdo_bins; // row length, band count
     sl::meta::dirty<glm::fvec3> ray_origin;
     sl::meta::dirty<glm::fvec2> window_size;
     sl::meta::dirty<DrawMode> draw_mode;
@@ -11,29 +11,31 @@ uniform float u_sound_level = 0; // [0, 1]
 
 #define M_PI 3.1415926535897932384626433832795
 
-const uint nfdo_N = 1024u;
-const float nfdo_logN = log(float(nfdo_N));
+uniform samplerBuffer nfdo; // rows of u_nfdo_N bands each: mid, left, right, side for stereo
+uniform uint u_nfdo_row = 0u;
+uniform uint u_nfdo_N = 256u; // band count, bands are already spaced on the chosen frequency scale
+uniform float u_nfdo_log_N = 5.5451774; // log(u_nfdo_N), set along with it so fragments do not recompute it
 
-uniform samplerBuffer nfdo;
 
 vec4 default_fill() {
     return vec4(1.0f, 0.5f, 0.2f, 1.0f);
 }
 
+// extra warp on top of the band scale, for RADIUS_LOG only
 float logspace(float v) {
-    return exp(v * nfdo_logN) / float(nfdo_N);
+    return exp(v * u_nfdo_log_N) / float(u_nfdo_N);
 }
 
 float nfdo_at(uint index) {
-    if (index < nfdo_N) {
-        return clamp(texelFetch(nfdo, int(index)).r, -1.0, 1.0);
+    if (index < u_nfdo_N) {
+        return clamp(texelFetch(nfdo, int(u_nfdo_row * u_nfdo_N + index)).r, -1.0, 1.0);
     } else {
         return 0.0;
     }
 }
 
 float nfdo_at_smoothed(float v) {
-    float u = v * float(nfdo_N);
+    float u = v * float(u_nfdo_N);
     uint i = uint(int(floor(u)));
     return mix(nfdo_at(i), nfdo_at(i + 1u), fract(u));
 }
@@ -122,12 +124,11 @@ rm_MO rm_map_the_world(vec3 p) {
         const float ypos = -0.5;
         float pr = length(p.xz);
         if (pr <= R) {
-            float v = clamp(pr / R, 0.0, 1.0);
-            float logspace_v = logspace(v);
-            float nfdo_value = nfdo_at_smoothed(logspace_v); // [-1, 1]
+            float v = clamp(pr / R, 0.0, 1.0); // bands are log, mel or bark spaced already, no warp per step
+            float nfdo_value = nfdo_at_smoothed(v); // [-1, 1]
             float h = (nfdo_value + 1) / 2; // [0, 1]
             float puddle_torus = rm_sd_torus(p, vec3(0.0, h - ypos, 0.0), pr, r);
-            vec3 color = mix(vec3(1.0, 0.0, 1.0), vec3(0.0, 1.0, 1.0), logspace_v);
+            vec3 color = mix(vec3(1.0, 0.0, 1.0), vec3(0.0, 1.0, 1.0), v);
             rm_smooth_union(mo, puddle_torus, mix(vec3(0.0), color, h), rm_TYPE_SOLID);
         }
     }
@@ -0,0 +1,197 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/analyzer.hpp"
+#include "audio/deinterleave.hpp"
+#include "audio/spectrum.hpp"
+#include "perf/histogram.hpp"
+
+#include <sl/meta/assert.hpp>
+
+#include <range/v3/algorithm/copy.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace audio {
+
+Spectrum::Spectrum(const DataConfig& config) : Spectrum{ config, config.frame_count / 2 } {}
+
+Spectrum::Spectrum(const DataConfig& config, std::size_t bins)
+    : rows{ planar_rows(config.capture_channels) }, //
+      bins{ bins }, //
+      normalized(rows * bins), //
+      level_sums(rows), //
+      time_domain(config.frame_count), //
+      freq_domain(config.frame_count / 2 + 1) {}
+
+Analyzer::Analyzer(const DataConfig& config)
+    : Analyzer{ config, std::make_shared<const RealFft>(config.frame_count) } {}
+
+Analyzer::Analyzer(
+    const DataConfig& config,
+    std::shared_ptr<const RealFft> fft,
+    bool parallel_rows,
+    std::shared_ptr<const ConstantQ> constant_q,
+    std::unique_ptr<MultiResolution> multi_resolution,
+    WindowFunction window_function
+)
+    : config_{ config }, //
+      fft_{ std::move(fft) }, //
+      constant_q_{ std::move(constant_q) }, //
+      window_{ constant_q_ ? WindowFunction::RECTANGULAR : window_function, config.frame_count }, //
+      rows_{ planar_rows(config.capture_channels) }, //
+      time_domain_(rows_ * config.frame_count), //
+      freq_domain_(rows_ * fft_->bins()), //
+      constant_q_domain_(constant_q_ ? rows_ * constant_q_->bins() : 0), //
+      multi_resolution_{ std::move(multi_resolution) }, //
+      hop_domain_(multi_resolution_ ? rows_ * multi_resolution_->hop() : 0), //
+      fork_join_{ parallel_rows ? rows_ - 1 : 0 } {
+    ASSERT(fft_->size() == config_.frame_count);
+    ASSERT(!constant_q_ || constant_q_->fft_size() == config_.frame_count);
+    ASSERT(!multi_resolution_ || (!constant_q_ && multi_resolution_->bins() == bins()));
+    time_domain_rows_.reserve(rows_);
+    for (std::size_t row = 0; row < rows_; ++row) {
+        time_domain_rows_.push_back(std::span{ time_domain_ }.subspan(row * config_.frame_count, config_.frame_count));
+    }
+    if (multi_resolution_) {
+        const std::size_t hop = multi_resolution_->hop();
+        hop_domain_rows_.reserve(rows_);
+        for (std::size_t row = 0; row < rows_; ++row) {
+            hop_domain_rows_.push_back(std::span{ hop_domain_ }.subspan(row * hop, hop));
+        }
+    }
+}
+
+bool Analyzer::update(DataCallback& callback, Spectrum& spectrum, bool take_snapshot) {
+    namespace r = ranges;
+    ASSERT(spectrum.rows == rows_ && spectrum.bins == bins());
+    if (multi_resolution_) {
+        return update_multi_resolution(callback, spectrum, take_snapshot);
+    }
+
+    // LATENCY POLICY: stale windows are skipped in the ring, without being copied or deinterleaved
+    callback.skip_stale(config_, kept_windows_.load(std::memory_order::relaxed));
+
+    // FETCH TIME DOMAIN INPUT
+    // every consumed window is one hop of config.frame_window frames ahead of the previous one
+    // a torn window is overwritten in full by the next one, so nothing has to be undone
+    capture_clock::time_point window_captured_at;
+    const bool has_new_window =
+        callback.try_consume(config_, [&](std::span<const std::byte> input, capture_clock::time_point captured_at) {
+            ASSERT(input.size() == config_.frame_size * config_.sample_size);
+            const perf::ScopedTimer timer{ perf::Stage::DEINTERLEAVE };
+            deinterleave(input, config_.format, config_.capture_channels, time_domain_rows_, window_.coefficients());
+            window_captured_at = captured_at;
+        });
+    if (!has_new_window) {
+        return false;
+    }
+    spectrum.captured_at = window_captured_at;
+
+    const std::size_t fft_bins = fft_->bins();
+    auto analyse_row = [&](std::size_t row) {
+        const auto freq_domain_row = std::span{ freq_domain_ }.subspan(row * fft_bins, fft_bins);
+        const auto normalized_row = std::span{ spectrum.normalized }.subspan(row * spectrum.bins, spectrum.bins);
+
+        // CALCULATE FFT (TIME DOMAIN -> FREQ DOMAIN), only N / 2 + 1 non-redundant bins
+        {
+            const perf::ScopedTimer timer{ perf::Stage::FFT };
+            fft_->forward(time_domain_rows_[row], freq_domain_row);
+        }
+
+        // CONSTANT-Q: sparse kernels over the fft bins, the result keeps the fft scale
+        std::span<const std::complex<float>> spectrum_row = freq_domain_row;
+        if (constant_q_) {
+            const perf::ScopedTimer timer{ perf::Stage::CONSTANT_Q };
+            const std::size_t constant_q_bins = constant_q_->bins();
+            const auto constant_q_row = std::span{ constant_q_domain_ }.subspan(row * constant_q_bins, constant_q_bins);
+            constant_q_->apply(freq_domain_row, constant_q_row);
+            spectrum_row = constant_q_row;
+        }
+
+        // SPECTRUM: magnitude, log and normalization fused in one pass, sound level sum comes out of the same pass
+        const perf::ScopedTimer timer{ perf::Stage::SPECTRUM };
+        spectrum.level_sums[row] = normalized_log_spectrum(spectrum_row, config_.frame_count, normalized_row);
+    };
+    fork_join_.run(rows_, analyse_row);
+    spectrum.generation = ++generation_;
+
+    if (take_snapshot) {
+        r::copy(time_domain_rows_[0], spectrum.time_domain.begin());
+        r::copy(std::span{ freq_domain_ }.first(fft_bins), spectrum.freq_domain.begin());
+        spectrum.snapshot_generation = spectrum.generation;
+    }
+
+    return true;
+}
+
+bool Analyzer::update_multi_resolution(DataCallback& callback, Spectrum& spectrum, bool take_snapshot) {
+    namespace r = ranges;
+
+    // the levels assemble their windows themselves out of every sample, so the ring is read hop by hop
+    const std::size_t hop = multi_resolution_->hop();
+    const DataConfig hop_config{
+        config_.capture_channels, config_.sample_rate, hop, config_.max_frame_count, hop, config_.format,
+    };
+
+    // LATENCY POLICY: newest drains every pending hop and analyses once, skipping would leave gaps in the histories
+    // catch-up analyses one hop per update, anything beyond max_backlog windows is still skipped
+    // the mode decides, not kept_windows, a max_backlog of 1 still catches up hop by hop within that one window
+    std::size_t max_hops = std::numeric_limits<std::size_t>::max();
+    if (is_catching_up_.load(std::memory_order::relaxed)) {
+        const std::size_t kept_windows = kept_windows_.load(std::memory_order::relaxed);
+        callback.skip_stale(hop_config, kept_windows * (config_.frame_window / hop));
+        max_hops = 1;
+    }
+
+    // FETCH TIME DOMAIN INPUT AND DECIMATE, first row also goes into the full rate window for snapshots
+    // a hop only goes into the histories once it is known not to be torn
+    std::size_t hops = 0;
+    capture_clock::time_point hop_captured_at;
+    const auto fetch_hop = [&](std::span<const std::byte> input, capture_clock::time_point captured_at) {
+        const perf::ScopedTimer timer{ perf::Stage::DEINTERLEAVE };
+        deinterleave(input, config_.format, config_.capture_channels, hop_domain_rows_);
+        hop_captured_at = captured_at;
+    };
+    while (hops < max_hops && callback.try_consume(hop_config, fetch_hop)) {
+        const perf::ScopedTimer timer{ perf::Stage::DECIMATE };
+        for (std::size_t row = 0; row < rows_; ++row) {
+            multi_resolution_->push(row, hop_domain_rows_[row]);
+        }
+        const auto window = time_domain_rows_[0];
+        std::copy(window.begin() + static_cast<std::ptrdiff_t>(hop), window.end(), window.begin());
+        r::copy(hop_domain_rows_[0], window.end() - static_cast<std::ptrdiff_t>(hop));
+        spectrum.captured_at = hop_captured_at;
+        ++hops;
+    }
+    if (hops == 0) {
+        return false;
+    }
+
+    // FFT PER DUE LEVEL AND STITCH
+    auto analyse_row = [&](std::size_t row) {
+        const auto normalized_row = std::span{ spectrum.normalized }.subspan(row * spectrum.bins, spectrum.bins);
+        spectrum.level_sums[row] = multi_resolution_->analyse(row, normalized_row);
+    };
+    fork_join_.run(rows_, analyse_row);
+    spectrum.generation = ++generation_;
+
+    // the debug plots get the plain full window fft, only computed on request
+    if (take_snapshot) {
+        const auto window = window_.coefficients();
+        const auto history = time_domain_rows_[0];
+        for (std::size_t i = 0; i < history.size(); ++i) {
+            spectrum.time_domain[i] = window.empty() ? history[i] : history[i] * window[i];
+        }
+        const auto freq_domain_row = std::span{ freq_domain_ }.first(fft_->bins());
+        fft_->forward(spectrum.time_domain, freq_domain_row);
+        r::copy(freq_domain_row, spectrum.freq_domain.begin());
+        spectrum.snapshot_generation = spectrum.generation;
+    }
+
+    return true;
+}
+
+} // namespace audio
@@ -0,0 +1,97 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/bands.hpp"
+
+#include <sl/meta/assert.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace audio {
+namespace {
+
+float to_scale(BandScale scale, float frequency) {
+    switch (scale) {
+    case BandScale::LOG:
+        return std::log2(frequency);
+    case BandScale::MEL:
+        return 2595.0f * std::log10(1.0f + frequency / 700.0f);
+    case BandScale::BARK: // Traunmüller
+        return 26.81f * frequency / (1960.0f + frequency) - 0.53f;
+    case BandScale::LINEAR:
+    default:
+        break;
+    }
+    return frequency;
+}
+
+float from_scale(BandScale scale, float value) {
+    switch (scale) {
+    case BandScale::LOG:
+        return std::exp2(value);
+    case BandScale::MEL:
+        return 700.0f * (std::pow(10.0f, value / 2595.0f) - 1.0f);
+    case BandScale::BARK:
+        return 1960.0f * (value + 0.53f) / (26.28f - value);
+    case BandScale::LINEAR:
+    default:
+        break;
+    }
+    return value;
+}
+
+} // namespace
+
+BandMap::BandMap(const BandConfig& config, std::size_t bins, ma_uint32 sample_rate) : config_{ config }, bins_{ bins } {
+    ASSERT(bins_ >= 2 && config_.bands > 0);
+    ranges_.reserve(config_.bands);
+
+    // bin k is at k * sample_rate / N, there are N / 2 of them
+    const float nyquist = static_cast<float>(sample_rate) / 2.0f;
+    const float bin_width = nyquist / static_cast<float>(bins_);
+    const float max_frequency = config_.max_frequency > 0.0f ? std::min(config_.max_frequency, nyquist) : nyquist;
+    const float min_frequency = std::clamp(config_.min_frequency, bin_width, max_frequency);
+
+    const float scale_min = to_scale(config_.scale, min_frequency);
+    const float scale_max = to_scale(config_.scale, max_frequency);
+    const float scale_step = (scale_max - scale_min) / static_cast<float>(config_.bands);
+    const auto edge_at = [&](std::size_t band) { // in fractional bins
+        return from_scale(config_.scale, scale_min + scale_step * static_cast<float>(band)) / bin_width;
+    };
+
+    const float last_bin = static_cast<float>(bins_ - 1);
+    float lower = edge_at(0);
+    for (std::size_t band = 0; band < config_.bands; ++band) {
+        const float upper = edge_at(band + 1);
+        if (upper - lower < 1.0f) {
+            const float centre = std::clamp((lower + upper) / 2.0f, 0.0f, last_bin - 1.0f);
+            const float first = std::floor(centre);
+            const auto first_bin = static_cast<std::uint32_t>(first);
+            ranges_.push_back(Range{ .first = first_bin, .last = first_bin, .fraction = centre - first });
+        } else {
+            const auto first_bin = static_cast<std::uint32_t>(std::clamp(std::round(lower), 0.0f, last_bin));
+            // the top edge is inclusive, so the last band keeps the bin at max_frequency, which at nyquist is the last
+            const float upper_end = band + 1 == config_.bands ? std::floor(upper) + 1.0f : std::round(upper);
+            const auto upper_bin = static_cast<std::uint32_t>(std::clamp(upper_end, 0.0f, last_bin + 1.0f));
+            const std::uint32_t last = std::max(upper_bin, first_bin + 1);
+            ranges_.push_back(Range{ .first = first_bin, .last = last, .fraction = 0.0f });
+        }
+        lower = upper;
+    }
+}
+
+void BandMap::apply(std::span<const float> input, std::span<float> output) const {
+    ASSERT(input.size() == bins_ && output.size() == ranges_.size());
+    for (std::size_t band = 0; band < ranges_.size(); ++band) {
+        const Range& range = ranges_[band];
+        if (range.last == range.first) {
+            output[band] = input[range.first] + (input[range.first + 1] - input[range.first]) * range.fraction;
+        } else {
+            output[band] = *std::max_element(input.begin() + range.first, input.begin() + range.last);
+        }
+    }
+}
+
+} // namespace audio
@@ -0,0 +1,120 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/constant_q.hpp"
+#include "audio/fft.hpp"
+
+#include <sl/meta/assert.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace audio {
+namespace {
+
+// kernel spectrum entries below this fraction of its peak are dropped
+constexpr float sparsity_threshold = 0.01f;
+
+} // namespace
+
+float ConstantQConfig::erb_gamma(std::size_t bins_per_octave) {
+    const double alpha = std::exp2(1.0 / static_cast<double>(bins_per_octave)) - 1.0;
+    return static_cast<float>(24.7 * alpha / 0.108);
+}
+
+ConstantQ::ConstantQ(const ConstantQConfig& config, std::size_t fft_size, ma_uint32 sample_rate)
+    : config_{ config }, fft_size_{ fft_size } {
+    ASSERT(config_.bins_per_octave > 0 && config_.min_frequency > 0.0f);
+    const double rate = static_cast<double>(sample_rate);
+    const double nyquist = rate / 2.0;
+    const double alpha = std::exp2(1.0 / static_cast<double>(config_.bins_per_octave)) - 1.0;
+    // top bin has to stay below nyquist with half of its bandwidth
+    const double max_frequency = std::min(
+        config_.max_frequency > 0.0f ? static_cast<double>(config_.max_frequency) : nyquist,
+        nyquist / (1.0 + alpha / 2.0)
+    );
+    // a kernel longer than the fft would be cut to it and only get the resolution of the fft bins,
+    // so bins start where alpha * f + gamma reaches rate / fft_size
+    const double fft_bandwidth = rate / static_cast<double>(fft_size_);
+    const double min_frequency =
+        std::max(static_cast<double>(config_.min_frequency), (fft_bandwidth - config_.gamma) / alpha);
+    ASSERT(min_frequency < max_frequency);
+    min_frequency_ = static_cast<float>(min_frequency);
+    const auto bin_count = static_cast<std::size_t>(
+        std::floor(static_cast<double>(config_.bins_per_octave) * std::log2(max_frequency / min_frequency)) + 1
+    );
+    kernels_.reserve(bin_count);
+
+    const ComplexFft fft{ fft_size_ };
+    std::vector<std::complex<float>> kernel(fft_size_);
+    const std::size_t half = fft_size_ / 2 + 1;
+    for (std::size_t bin = 0; bin < bin_count; ++bin) {
+        const double frequency =
+            min_frequency * std::exp2(static_cast<double>(bin) / static_cast<double>(config_.bins_per_octave));
+        const double bandwidth = alpha * frequency + config_.gamma;
+        // clamped only against rounding at the lowest bin
+        const auto length = std::clamp<std::size_t>(static_cast<std::size_t>(rate / bandwidth), 2, fft_size_);
+
+        // hann windowed exponential in the middle of the frame, normalized so a full scale sine gives 1/2 like the fft
+        std::fill(kernel.begin(), kernel.end(), std::complex<float>{});
+        const auto hann = [length](std::size_t n) {
+            return 0.5 - 0.5 * std::cos(2.0 * std::numbers::pi * static_cast<double>(n) / static_cast<double>(length));
+        };
+        double window_sum = 0.0;
+        for (std::size_t n = 0; n < length; ++n) {
+            window_sum += hann(n);
+        }
+        const std::size_t start = (fft_size_ - length) / 2;
+        for (std::size_t n = 0; n < length; ++n) {
+            const double phase = 2.0 * std::numbers::pi * frequency * static_cast<double>(n) / rate;
+            kernel[start + n] = std::polar(static_cast<float>(hann(n) / window_sum), static_cast<float>(phase));
+        }
+        fft.forward(kernel);
+
+        // Parseval: sum x[n] conj(k[n]) == sum X[j] conj(K[j]) / N, the / N is left out to keep the fft scale
+        // the kernel is analytic, so the negative frequencies it would also touch are negligible
+        float peak = 0.0f;
+        for (std::size_t j = 0; j < half; ++j) {
+            peak = std::max(peak, std::abs(kernel[j]));
+        }
+        std::size_t first = 0;
+        while (first < half && std::abs(kernel[first]) < peak * sparsity_threshold) {
+            ++first;
+        }
+        std::size_t last = half;
+        while (last > first && std::abs(kernel[last - 1]) < peak * sparsity_threshold) {
+            --last;
+        }
+        kernels_.push_back(Kernel{
+            .offset = static_cast<std::uint32_t>(coefficients_.size()),
+            .first = static_cast<std::uint32_t>(first),
+            .count = static_cast<std::uint32_t>(last - first),
+        });
+        for (std::size_t j = first; j < last; ++j) {
+            coefficients_.push_back(std::conj(kernel[j]));
+        }
+    }
+}
+
+void ConstantQ::apply(std::span<const std::complex<float>> input, std::span<std::complex<float>> output) const {
+    ASSERT(input.size() == fft_size_ / 2 + 1 && output.size() == kernels_.size());
+    for (std::size_t bin = 0; bin < kernels_.size(); ++bin) {
+        const Kernel& kernel = kernels_[bin];
+        const auto fft_bins = input.subspan(kernel.first, kernel.count);
+        const auto coefficients = std::span{ coefficients_ }.subspan(kernel.offset, kernel.count);
+        // spelled out, std::complex multiplication checks for infinities and does not vectorize
+        float real = 0.0f;
+        float imag = 0.0f;
+        for (std::size_t j = 0; j < kernel.count; ++j) {
+            const std::complex<float> x = fft_bins[j];
+            const std::complex<float> c = coefficients[j];
+            real += x.real() * c.real() - x.imag() * c.imag();
+            imag += x.real() * c.imag() + x.imag() * c.real();
+        }
+        output[bin] = std::complex<float>{ real, imag };
+    }
+}
+
+} // namespace audio
@@ -19,6 +19,31 @@ Context::Context(const std::vector<ma_backend>& backends, ma_context_config cont
 
 std::string_view Context::backend_name() const { return ma::get_backend_name(context_->backend); }
 
+NativeFormat Context::capture_native_format(std::size_t index, const NativeFormat& fallback) const {
+    ASSERT(index < capture_infos_.size());
+    const ma_device_info& capture_info = capture_infos_[index];
+    const auto maybe_device_info =
+        ma::context_get_device_info(context_, ma_device_type_capture, capture_info.id).map_error([&](ma_result result) {
+            spdlog::warn("[miniaudio] no native format for {}: {}", capture_info.name, ma::result_description(result));
+            return result;
+        });
+    if (!maybe_device_info) {
+        return fallback;
+    }
+
+    const ma_device_info& device_info = *maybe_device_info;
+    if (device_info.nativeDataFormatCount == 0) {
+        return fallback;
+    }
+    // backends list the format they actually run in first
+    const auto& native = device_info.nativeDataFormats[0];
+    return NativeFormat{
+        .format = native.format != ma_format_unknown ? native.format : fallback.format,
+        .channels = native.channels != 0 ? native.channels : fallback.channels,
+        .sample_rate = native.sampleRate != 0 ? native.sampleRate : fallback.sample_rate,
+    };
+}
+
 sl::meta::result<ma::device_uptr, ma_result> Context::create_device(
     ma_device_type device_type,
     const DataConfig& data_config,
@@ -36,7 +61,7 @@ sl::meta::result<ma::device_uptr, ma_result> Context::create_device(
     }
     if (device_type & ma_device_type::ma_device_type_capture || device_type == ma_device_type_loopback) {
         ASSERT(capture_config.index < capture_infos_.size());
-        device_config.capture.format = format;
+        device_config.capture.format = data_config.format;
         device_config.capture.channels = capture_config.channels;
         device_config.capture.pDeviceID = &capture_infos_[capture_config.index].id;
     }
@@ -3,29 +3,46 @@
 //
 
 #include "audio/data.hpp"
+#include "perf/histogram.hpp"
+#include "perf/trace.hpp"
 
-#include <sl/exec/algo/emit/detach.hpp>
-#include <sl/exec/algo/make/result.hpp>
-#include <sl/exec/algo/sched/continue_on.hpp>
-#include <sl/exec/algo/tf/seq/map.hpp>
-#include <sl/exec/model/syntax.hpp>
+#include <algorithm>
 
 namespace audio {
 
-void DataCallback::operator()(std::span<const float> input) {
-    using namespace sl::exec;
-
-    value_as_signal(ChunkT{ input.begin(), input.end() }) //
-        | continue_on(sync_executor_) //
-        | map([this](ChunkT&& chunk) {
-              if (chunk_.empty()) {
-                  chunk_ = std::move(chunk);
-              } else {
-                  chunk_.insert(chunk_.end(), chunk.begin(), chunk.end());
-              }
-              return sl::meta::unit{};
-          })
-        | detach();
+void DataCallback::operator()(std::span<const std::byte> input) {
+    perf::trace::name_thread("audio device");
+    const perf::trace::Scope trace{ "DataCallback" };
+    const perf::ScopedTimer timer{ perf::Stage::INGESTION };
+    const capture_clock::time_point now = capture_clock::now();
+    const std::uint64_t position = ring_.push(input);
+
+    const std::uint32_t sequence = stamp_sequence_.load(std::memory_order::relaxed);
+    stamp_sequence_.store(sequence + 1, std::memory_order::relaxed);
+    std::atomic_thread_fence(std::memory_order::release);
+    stamp_position_.store(position, std::memory_order::relaxed);
+    stamp_time_.store(now.time_since_epoch().count(), std::memory_order::relaxed);
+    stamp_sequence_.store(sequence + 2, std::memory_order::release);
+}
+
+capture_clock::time_point DataCallback::captured_at(std::uint64_t position) const {
+    std::uint64_t stamp_position = 0;
+    capture_clock::rep stamp_time = 0;
+    while (true) {
+        const std::uint32_t sequence = stamp_sequence_.load(std::memory_order::acquire);
+        stamp_position = stamp_position_.load(std::memory_order::relaxed);
+        stamp_time = stamp_time_.load(std::memory_order::relaxed);
+        std::atomic_thread_fence(std::memory_order::acquire);
+        if (sequence % 2 == 0 && sequence == stamp_sequence_.load(std::memory_order::relaxed)) {
+            break;
+        }
+    }
+
+    // the stamp of the push that made position readable may not be published yet, then the previous one is closest
+    const auto behind_bytes = static_cast<double>(stamp_position - std::min(position, stamp_position));
+    const std::chrono::duration<double> behind{ behind_bytes / bytes_per_second_ };
+    return capture_clock::time_point{ capture_clock::duration{ stamp_time } } -
+           std::chrono::duration_cast<capture_clock::duration>(behind);
 }
 
 } // namespace audio
@@ -0,0 +1,107 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/decimator.hpp"
+
+#include <sl/meta/assert.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <numbers>
+#include <numeric>
+
+namespace audio {
+namespace {
+
+// 60 dB stopband, 16 taps per phase is then just enough for the transition from 3/4 to 5/4 of the output nyquist
+// measured, 5.65 from the kaiser formula leaves the stopband edge at -59 dB, 6.0 gets it to -62 dB
+constexpr double kaiser_beta = 6.0;
+
+// kaiser windowed sinc with the cutoff at the output nyquist, unity gain at dc
+std::vector<float> make_prototype(std::size_t factor, std::size_t taps) {
+    std::vector<double> prototype(taps);
+    const double cutoff = 0.5 / static_cast<double>(factor); // of the input rate
+    const double center = static_cast<double>(taps - 1) / 2.0;
+    const double window_scale = 1.0 / std::cyl_bessel_i(0.0, kaiser_beta);
+    for (std::size_t n = 0; n < taps; ++n) {
+        const double x = static_cast<double>(n) - center;
+        const double arg = 2.0 * std::numbers::pi * cutoff * x;
+        const double sinc = 2.0 * cutoff * (x == 0.0 ? 1.0 : std::sin(arg) / arg);
+        const double ratio = x / center;
+        const double window = std::cyl_bessel_i(0.0, kaiser_beta * std::sqrt(1.0 - ratio * ratio)) * window_scale;
+        prototype[n] = sinc * window;
+    }
+    const double sum = std::accumulate(prototype.begin(), prototype.end(), 0.0);
+
+    std::vector<float> phase_major(taps);
+    const std::size_t per_phase = taps / factor;
+    for (std::size_t p = 0; p < factor; ++p) {
+        for (std::size_t j = 0; j < per_phase; ++j) {
+            phase_major[p * per_phase + j] = static_cast<float>(prototype[j * factor + p] / sum);
+        }
+    }
+    return phase_major;
+}
+
+} // namespace
+
+Decimator::Decimator(std::size_t factor, std::size_t max_input)
+    : factor_{ factor }, //
+      max_input_{ max_input }, //
+      phase_stride_{ taps_per_phase - 1 + max_input / factor }, //
+      taps_{ make_prototype(factor, factor * taps_per_phase) }, //
+      phases_(factor * phase_stride_) {
+    ASSERT(std::has_single_bit(factor_) && factor_ >= 2 && factor_ <= max_factor);
+    ASSERT(max_input_ % factor_ == 0);
+}
+
+void Decimator::process(std::span<const float> input, std::span<float> output) {
+    ASSERT(input.size() % factor_ == 0 && input.size() <= max_input_);
+    const std::size_t outputs = input.size() / factor_;
+    ASSERT(output.size() == outputs);
+
+    // COMMUTATOR: input sample m * factor + p is the next sample of phase p, after its state
+    for (std::size_t p = 0; p < factor_; ++p) {
+        float* x = phase(p) + taps_per_phase - 1;
+        for (std::size_t m = 0; m < outputs; ++m) {
+            x[m] = input[m * factor_ + p];
+        }
+    }
+
+    // FIR PER PHASE: output i of phase p is sum over j of h_p[j] x_p[i + j], summed over the phases
+    // blocks of independent outputs over contiguous input, the accumulators stay in a vector register throughout
+    constexpr std::size_t lanes = 8;
+    const auto accumulate_block = [this]<std::size_t block_lanes>(std::size_t first, std::span<float, block_lanes> y) {
+        std::array<float, block_lanes> acc{};
+        for (std::size_t p = 0; p < factor_; ++p) {
+            const float* x = phase(p) + first;
+            const float* h = taps_.data() + p * taps_per_phase;
+            for (std::size_t j = 0; j < taps_per_phase; ++j) {
+                for (std::size_t lane = 0; lane < block_lanes; ++lane) {
+                    acc[lane] += h[j] * x[j + lane];
+                }
+            }
+        }
+        std::copy(acc.begin(), acc.end(), y.begin());
+    };
+    const std::size_t blocked_outputs = outputs - outputs % lanes;
+    for (std::size_t i = 0; i < blocked_outputs; i += lanes) {
+        accumulate_block(i, output.subspan(i).first<lanes>());
+    }
+    for (std::size_t i = blocked_outputs; i < outputs; ++i) {
+        accumulate_block(i, output.subspan(i).first<1>());
+    }
+
+    // STATE: last taps_per_phase - 1 samples of every phase go in front of the next call
+    for (std::size_t p = 0; p < factor_; ++p) {
+        float* x = phase(p);
+        std::copy(x + outputs, x + outputs + taps_per_phase - 1, x);
+    }
+}
+
+void Decimator::reset() { std::fill(phases_.begin(), phases_.end(), 0.0f); }
+
+} // namespace audio
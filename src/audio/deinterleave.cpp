@@ -0,0 +1,196 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/deinterleave.hpp"
+
+#include <sl/meta/assert.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace audio {
+namespace {
+
+// one sample of a given format at p as float in [-1, 1]
+template <ma_format format>
+float load_sample(const std::byte* p) {
+    if constexpr (format == ma_format_f32) {
+        float x;
+        std::memcpy(&x, p, sizeof(x));
+        return x;
+    } else if constexpr (format == ma_format_s32) {
+        std::int32_t x;
+        std::memcpy(&x, p, sizeof(x));
+        return static_cast<float>(x) * (1.0f / 2147483648.0f);
+    } else if constexpr (format == ma_format_s24) { // packed little-endian, shifted into the top of an int32
+        const auto x = static_cast<std::int32_t>(
+            (static_cast<std::uint32_t>(p[0]) << 8) | (static_cast<std::uint32_t>(p[1]) << 16)
+            | (static_cast<std::uint32_t>(p[2]) << 24)
+        );
+        return static_cast<float>(x) * (1.0f / 2147483648.0f);
+    } else if constexpr (format == ma_format_s16) {
+        std::int16_t x;
+        std::memcpy(&x, p, sizeof(x));
+        return static_cast<float>(x) * (1.0f / 32768.0f);
+    } else if constexpr (format == ma_format_u8) {
+        return (static_cast<float>(p[0]) - 128.0f) * (1.0f / 128.0f);
+    } else {
+        static_assert(format == ma_format_f32, "unsupported format");
+    }
+}
+
+// conversion and windowing are fused into the deinterleave,
+// plain indexed loops over raw pointers get vectorized by the compiler
+template <ma_format format, bool is_windowed>
+void deinterleave_as(
+    const std::byte* const in,
+    std::size_t frames,
+    ma_uint32 channels,
+    std::span<const std::span<float>> rows,
+    const float* const window
+) {
+    constexpr std::size_t sample_size = bytes_per_sample(format);
+    const auto load = [in, window](std::size_t i, std::size_t sample) {
+        const float x = load_sample<format>(in + sample * sample_size);
+        if constexpr (is_windowed) {
+            return x * window[i];
+        } else {
+            return x;
+        }
+    };
+    switch (channels) {
+    case 1: {
+        float* const out = rows[0].data();
+        for (std::size_t i = 0; i < frames; ++i) {
+            out[i] = load(i, i);
+        }
+        break;
+    }
+    case 2: {
+        float* const mid = rows[0].data();
+        float* const left = rows[1].data();
+        float* const right = rows[2].data();
+        float* const side = rows[3].data();
+        for (std::size_t i = 0; i < frames; ++i) {
+            const float l = load(i, 2 * i);
+            const float r = load(i, 2 * i + 1);
+            left[i] = l;
+            right[i] = r;
+            mid[i] = (l + r) * 0.5f;
+            side[i] = (l - r) * 0.5f;
+        }
+        break;
+    }
+    default: {
+        float* const mid = rows[0].data();
+        const float mid_scale = 1.0f / static_cast<float>(channels);
+        std::fill_n(mid, frames, 0.0f);
+        for (ma_uint32 channel = 0; channel < channels; ++channel) {
+            float* const out = rows[1 + channel].data();
+            for (std::size_t i = 0; i < frames; ++i) {
+                const float x = load(i, i * channels + channel);
+                out[i] = x;
+                mid[i] += x * mid_scale;
+            }
+        }
+        break;
+    }
+    }
+}
+
+// "channel 0" up to the last channel miniaudio supports, built at compile time so naming a row never allocates
+constexpr auto channel_names = [] {
+    constexpr std::string_view prefix = "channel ";
+    std::array<std::array<char, sizeof("channel 999")>, MA_MAX_CHANNELS> names{};
+    for (std::size_t channel = 0; channel < names.size(); ++channel) {
+        auto& name = names[channel];
+        std::copy(prefix.begin(), prefix.end(), name.begin());
+        std::size_t size = prefix.size();
+        std::array<char, 3> digits{};
+        std::size_t digit_count = 0;
+        for (std::size_t value = channel; digit_count == 0 || value > 0; value /= 10) {
+            digits[digit_count++] = static_cast<char>('0' + value % 10);
+        }
+        while (digit_count > 0) {
+            name[size++] = digits[--digit_count];
+        }
+    }
+    return names;
+}();
+
+} // namespace
+
+std::size_t planar_rows(ma_uint32 channels) {
+    ASSERT(channels > 0);
+    switch (channels) {
+    case 1:
+        return 1;
+    case 2:
+        return 4;
+    default:
+        return 1 + channels;
+    }
+}
+
+std::string_view planar_row_name(ma_uint32 channels, std::size_t row) {
+    ASSERT(row < planar_rows(channels));
+    switch (channels) {
+    case 1:
+        return "mono";
+    case 2: {
+        constexpr std::array names{ "mid", "left", "right", "side" };
+        return names[row];
+    }
+    default:
+        return row == 0 ? std::string_view{ "mid" } : std::string_view{ channel_names[row - 1].data() };
+    }
+}
+
+void deinterleave(
+    std::span<const std::byte> input,
+    ma_format format,
+    ma_uint32 channels,
+    std::span<const std::span<float>> rows,
+    std::span<const float> window
+) {
+    ASSERT(rows.size() == planar_rows(channels));
+    const std::size_t frames = input.size() / (channels * bytes_per_sample(format));
+    for (const auto& row : rows) {
+        ASSERT(row.size() == frames);
+    }
+    ASSERT(window.empty() || window.size() == frames);
+
+    const auto deinterleave_windowed = [&]<ma_format format_v>() {
+        if (window.empty()) {
+            deinterleave_as<format_v, false>(input.data(), frames, channels, rows, nullptr);
+        } else {
+            deinterleave_as<format_v, true>(input.data(), frames, channels, rows, window.data());
+        }
+    };
+    switch (format) {
+    case ma_format_f32:
+        deinterleave_windowed.operator()<ma_format_f32>();
+        break;
+    case ma_format_s32:
+        deinterleave_windowed.operator()<ma_format_s32>();
+        break;
+    case ma_format_s24:
+        deinterleave_windowed.operator()<ma_format_s24>();
+        break;
+    case ma_format_s16:
+        deinterleave_windowed.operator()<ma_format_s16>();
+        break;
+    case ma_format_u8:
+        deinterleave_windowed.operator()<ma_format_u8>();
+        break;
+    default:
+        ASSERT(false);
+        break;
+    }
+}
+
+} // namespace audio
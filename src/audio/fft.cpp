@@ -0,0 +1,107 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/fft.hpp"
+
+#include <sl/meta/assert.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <numbers>
+
+namespace audio {
+namespace {
+
+std::complex<float> twiddle(std::size_t k, std::size_t n) {
+    const double theta = -2.0 * std::numbers::pi * static_cast<double>(k) / static_cast<double>(n);
+    return std::complex<float>{ std::polar(1.0, theta) };
+}
+
+} // namespace
+
+ComplexFft::ComplexFft(std::size_t size) : size_{ size } {
+    ASSERT(size_ >= 1 && std::has_single_bit(size_));
+    const int bits = std::countr_zero(size_);
+    for (std::size_t i = 0; i < size_; ++i) {
+        std::size_t reversed = 0;
+        for (int bit = 0; bit < bits; ++bit) {
+            reversed |= ((i >> bit) & 1u) << (bits - 1 - bit);
+        }
+        if (i < reversed) {
+            bit_reversal_swaps_.emplace_back(static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(reversed));
+        }
+    }
+
+    twiddles_.reserve(size_ / 2);
+    for (std::size_t k = 0; k < size_ / 2; ++k) {
+        twiddles_.push_back(twiddle(k, size_));
+    }
+}
+
+void ComplexFft::forward(std::span<std::complex<float>> data) const {
+    ASSERT(data.size() == size_);
+    for (const auto& [i, j] : bit_reversal_swaps_) {
+        std::swap(data[i], data[j]);
+    }
+
+    for (std::size_t length = 2; length <= size_; length *= 2) {
+        const std::size_t half_length = length / 2;
+        const std::size_t twiddle_stride = size_ / length;
+        for (std::size_t offset = 0; offset < size_; offset += length) {
+            for (std::size_t k = 0; k < half_length; ++k) {
+                const std::complex<float> a = data[offset + k];
+                const std::complex<float> b = data[offset + k + half_length] * twiddles_[k * twiddle_stride];
+                data[offset + k] = a + b;
+                data[offset + k + half_length] = a - b;
+            }
+        }
+    }
+}
+
+RealFft::RealFft(std::size_t size) : size_{ size }, half_{ size / 2 } {
+    ASSERT(size_ >= 2 && std::has_single_bit(size_));
+    untangle_twiddles_.reserve(size_ / 2 + 1);
+    for (std::size_t k = 0; k <= size_ / 2; ++k) {
+        untangle_twiddles_.push_back(twiddle(k, size_));
+    }
+}
+
+void RealFft::forward(std::span<const float> input, std::span<std::complex<float>> output) const {
+    ASSERT(input.size() == size_ && output.size() == bins());
+    const std::size_t M = size_ / 2;
+
+    // pack even samples as real and odd samples as imaginary parts, then transform half the size in place
+    for (std::size_t n = 0; n < M; ++n) {
+        output[n] = std::complex<float>{ input[2 * n], input[2 * n + 1] };
+    }
+    half_.forward(output.first(M));
+
+    // untangle spectra of even and odd samples: X[k] = E[k] + e^(-2 pi i k / N) O[k]
+    // bins k and M - k depend on the same pair Z[k], Z[M - k], so they are written together
+    const std::complex<float> z0 = output[0];
+    output[0] = std::complex<float>{ z0.real() + z0.imag(), 0.0f };
+    output[M] = std::complex<float>{ z0.real() - z0.imag(), 0.0f };
+    for (std::size_t k = 1; k <= M / 2; ++k) {
+        const std::complex<float> z = output[k];
+        const std::complex<float> z_mirror = output[M - k];
+
+        const std::complex<float> even = 0.5f * (z + std::conj(z_mirror));
+        const std::complex<float> odd = std::complex<float>{ 0.0f, -0.5f } * (z - std::conj(z_mirror));
+        const std::complex<float> even_mirror = std::conj(even);
+        const std::complex<float> odd_mirror = std::conj(odd);
+
+        output[k] = even + untangle_twiddles_[k] * odd;
+        output[M - k] = even_mirror + untangle_twiddles_[M - k] * odd_mirror;
+    }
+}
+
+std::shared_ptr<const RealFft> FftPlanCache::real(std::size_t size) {
+    const auto it = std::find_if(real_.begin(), real_.end(), [size](const auto& plan) { return plan->size() == size; });
+    if (it != real_.end()) {
+        return *it;
+    }
+    return real_.emplace_back(std::make_shared<const RealFft>(size));
+}
+
+} // namespace audio
@@ -0,0 +1,117 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/file_source.hpp"
+#include "audio/pacer.hpp"
+#include "perf/realtime.hpp"
+#include "perf/trace.hpp"
+
+#include <sl/meta/assert.hpp>
+
+#include <fmt/format.h>
+
+namespace audio {
+namespace {
+
+// runs in the first member initializer of FileDevice, so a mismatch is caught before its thread starts
+std::unique_ptr<FileSource> checked_source(std::unique_ptr<FileSource> source, const DataConfig& data_config) {
+    const NativeFormat native_format = source->native_format();
+    ASSERT(native_format.format == data_config.format && native_format.channels == data_config.capture_channels);
+    return source;
+}
+
+} // namespace
+
+sl::meta::result<std::unique_ptr<FileSource>, std::string> FileSource::open(const std::filesystem::path& path) {
+    return MappedFile::open(path)
+        .map_error([&](const std::error_code& error) { return fmt::format("{}: {}", path.string(), error.message()); })
+        .and_then([&](auto&& file) {
+            // zeroes keep the format, channels and sample rate of the file
+            const ma_decoder_config decoder_config = ma_decoder_config_init(ma_format_unknown, 0, 0);
+            return ma::decoder_init_memory(file.data(), decoder_config)
+                .map_error([&](ma_result result) {
+                    return fmt::format("{}: {}", path.string(), ma::result_description(result));
+                })
+                .map([&](auto&& decoder) {
+                    return std::unique_ptr<FileSource>{ new FileSource{ std::move(file), std::move(decoder) } };
+                });
+        });
+}
+
+FileSource::FileSource(MappedFile file, ma::decoder_uptr decoder)
+    : file_{ std::move(file) }, decoder_{ std::move(decoder) } {
+    // the mapping itself does not move, so the decoder keeps reading from the same memory
+    if (ma_decoder_get_length_in_pcm_frames(decoder_.get(), &length_) != MA_SUCCESS) {
+        length_ = 0;
+    }
+}
+
+NativeFormat FileSource::native_format() const {
+    return NativeFormat{
+        .format = decoder_->outputFormat,
+        .channels = decoder_->outputChannels,
+        .sample_rate = decoder_->outputSampleRate,
+    };
+}
+
+ma_uint64 FileSource::read(std::span<std::byte> output, ma_uint64 frame_count) {
+    ma_uint64 frames_read = 0;
+    ma_decoder_read_pcm_frames(decoder_.get(), output.data(), frame_count, &frames_read);
+    return frames_read;
+}
+
+bool FileSource::seek(ma_uint64 frame) { return ma_decoder_seek_to_pcm_frame(decoder_.get(), frame) == MA_SUCCESS; }
+
+ma_uint64 FileSource::cursor() const {
+    ma_uint64 cursor = 0;
+    if (ma_decoder_get_cursor_in_pcm_frames(decoder_.get(), &cursor) != MA_SUCCESS) {
+        return 0;
+    }
+    return cursor;
+}
+
+FileDevice::FileDevice(
+    const DataConfig& data_config,
+    std::unique_ptr<FileSource> source,
+    DataCallback& callback,
+    ma_uint32 period_frames,
+    double speed
+)
+    : source_{ checked_source(std::move(source), data_config) }, //
+      sample_rate_{ data_config.sample_rate }, //
+      period_frames_{ period_frames }, //
+      bytes_per_frame_{ data_config.bytes_per_frame() }, //
+      period_(period_frames * data_config.bytes_per_frame()), //
+      position_{ source_->cursor() }, //
+      thread_{ [this, &callback, speed](std::stop_token stop_token) {
+          run(std::move(stop_token), callback, speed);
+      } } {}
+
+void FileDevice::run(std::stop_token stop_token, DataCallback& callback, double speed) {
+    perf::trace::name_thread("file device");
+    Pacer pacer{ period_frames_, sample_rate_, speed };
+    ma_uint64 position = position_.load(std::memory_order::relaxed);
+    while (!stop_token.stop_requested()) {
+        if (const ma_uint64 frame = seek_request_.exchange(no_seek, std::memory_order::relaxed); frame != no_seek) {
+            if (source_->seek(frame)) {
+                position = frame;
+            }
+        }
+
+        const ma_uint64 frames_read = source_->read(period_, period_frames_);
+        if (frames_read > 0) {
+            const perf::realtime::Section realtime;
+            callback(std::span<const std::byte>{ period_ }.first(frames_read * bytes_per_frame_));
+            position += frames_read;
+        }
+        if (frames_read < period_frames_ && source_->seek(0)) { // end of file, start over
+            position = 0;
+        }
+        position_.store(position, std::memory_order::relaxed);
+        pacer.wait();
+    }
+    perf::trace::release_thread("file device");
+}
+
+} // namespace audio
@@ -0,0 +1,71 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/fork_join.hpp"
+
+namespace audio {
+
+ForkJoin::ForkJoin(std::size_t threads) {
+    threads_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+        threads_.emplace_back([this](std::stop_token stop_token) { worker_loop(std::move(stop_token)); });
+    }
+}
+
+ForkJoin::~ForkJoin() {
+    for (auto& thread : threads_) {
+        thread.request_stop();
+    }
+    generation_.fetch_add(1, std::memory_order::release);
+    generation_.notify_all();
+}
+
+void ForkJoin::run_erased(std::size_t size, erased_task task, void* context) {
+    task_ = task;
+    context_ = context;
+    size_ = size;
+    next_.store(0, std::memory_order::relaxed);
+
+    if (size <= 1 || threads_.empty()) {
+        work();
+        return;
+    }
+
+    // every thread takes part in every batch, so none of them can linger into the next one
+    acknowledged_.store(0, std::memory_order::relaxed);
+    generation_.fetch_add(1, std::memory_order::release);
+    generation_.notify_all();
+
+    work();
+
+    const std::size_t threads = threads_.size();
+    for (std::size_t acknowledged = acknowledged_.load(std::memory_order::acquire); acknowledged < threads;
+         acknowledged = acknowledged_.load(std::memory_order::acquire)) {
+        acknowledged_.wait(acknowledged, std::memory_order::acquire);
+    }
+}
+
+void ForkJoin::work() {
+    for (std::size_t index = next_.fetch_add(1, std::memory_order::relaxed); index < size_;
+         index = next_.fetch_add(1, std::memory_order::relaxed)) {
+        task_(context_, index);
+    }
+}
+
+void ForkJoin::worker_loop(std::stop_token stop_token) {
+    std::uint64_t seen = 0; // not loaded here, the first batch may already be dispatched before this thread starts
+    while (true) {
+        generation_.wait(seen, std::memory_order::acquire);
+        seen = generation_.load(std::memory_order::acquire);
+        if (stop_token.stop_requested()) {
+            return;
+        }
+        work();
+        if (acknowledged_.fetch_add(1, std::memory_order::acq_rel) + 1 == threads_.size()) {
+            acknowledged_.notify_one();
+        }
+    }
+}
+
+} // namespace audio
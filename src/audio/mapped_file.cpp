@@ -0,0 +1,109 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/mapped_file.hpp"
+
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace audio {
+
+#if defined(_WIN32)
+
+sl::meta::result<MappedFile, std::error_code> MappedFile::open(const std::filesystem::path& path) {
+    const auto last_error = [] { return std::error_code{ static_cast<int>(GetLastError()), std::system_category() }; };
+
+    const HANDLE file = CreateFileW(
+        path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+        return sl::meta::err(last_error());
+    }
+    LARGE_INTEGER file_size{};
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        const auto error = file_size.QuadPart == 0 ? std::make_error_code(std::errc::invalid_argument) : last_error();
+        CloseHandle(file);
+        return sl::meta::err(error);
+    }
+
+    // view keeps the mapping alive, handles can be closed right away
+    const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        return sl::meta::err(last_error());
+    }
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == nullptr) {
+        return sl::meta::err(last_error());
+    }
+    return MappedFile{ static_cast<const std::byte*>(view), static_cast<std::size_t>(file_size.QuadPart) };
+}
+
+void MappedFile::unmap() {
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+    }
+}
+
+#else
+
+sl::meta::result<MappedFile, std::error_code> MappedFile::open(const std::filesystem::path& path) {
+    const auto last_error = [] { return std::error_code{ errno, std::system_category() }; };
+
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return sl::meta::err(last_error());
+    }
+    struct stat file_stat {};
+    if (::fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+        const auto error = file_stat.st_size == 0 ? std::make_error_code(std::errc::invalid_argument) : last_error();
+        ::close(fd);
+        return sl::meta::err(error);
+    }
+
+    const auto size = static_cast<std::size_t>(file_stat.st_size);
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // mapping keeps the file alive
+    if (data == MAP_FAILED) {
+        return sl::meta::err(last_error());
+    }
+    // decoding walks the file front to back
+    ::madvise(data, size, MADV_SEQUENTIAL);
+    return MappedFile{ static_cast<const std::byte*>(data), size };
+}
+
+void MappedFile::unmap() {
+    if (data_ != nullptr) {
+        ::munmap(const_cast<std::byte*>(data_), size_);
+    }
+}
+
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_{ std::exchange(other.data_, nullptr) }, size_{ std::exchange(other.size_, 0) } {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() { unmap(); }
+
+} // namespace audio
@@ -0,0 +1,136 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/multi_resolution.hpp"
+#include "audio/decimator.hpp"
+#include "audio/deinterleave.hpp"
+#include "audio/spectrum.hpp"
+#include "perf/histogram.hpp"
+
+#include <sl/meta/assert.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace audio {
+namespace {
+
+// shortest fft a level runs, below that the octaves get only a handful of bins
+constexpr std::size_t min_fft_size = 64;
+
+std::size_t clamp_levels(const DataConfig& config, std::size_t levels) {
+    levels = std::clamp<std::size_t>(levels, 1, std::bit_width(Decimator::max_factor));
+    // a hop is frame_window / decimation frames and has to decimate into whole samples at every level,
+    // and the fft has to be still worth running
+    const auto fits = [&config](std::size_t levels) {
+        const std::size_t decimation = 1uz << (levels - 1);
+        return config.frame_count / decimation >= min_fft_size && config.frame_window % (decimation * decimation) == 0;
+    };
+    while (levels > 1 && !fits(levels)) {
+        --levels;
+    }
+    return levels;
+}
+
+} // namespace
+
+MultiResolution::MultiResolution(
+    const DataConfig& config,
+    const MultiResolutionConfig& multi_resolution_config,
+    FftPlanCache& fft_plans
+)
+    : levels_{ clamp_levels(config, multi_resolution_config.levels) }, //
+      hop_{ config.frame_window >> (levels_ - 1) }, //
+      bins_{ config.frame_count / 2 }, //
+      fft_{ fft_plans.real(config.frame_count >> (levels_ - 1)) }, //
+      window_{ multi_resolution_config.window_function, fft_->size() }, //
+      log_gain_{ std::log(static_cast<float>(config.frame_count / fft_->size()))
+                 / std::log(static_cast<float>(config.frame_count)) } {
+    const std::size_t fft_size = fft_->size();
+    const std::size_t rows = planar_rows(config.capture_channels);
+    lanes_.resize(rows * levels_);
+    for (std::size_t row = 0; row < rows; ++row) {
+        for (std::size_t level = 0; level < levels_; ++level) {
+            Lane& row_lane = lane(row, level);
+            if (level > 0) {
+                row_lane.decimator.emplace(1uz << level, hop_);
+            }
+            row_lane.history.resize(fft_size);
+            row_lane.windowed.resize(window_.coefficients().size());
+            row_lane.freq_domain.resize(fft_->bins());
+            row_lane.normalized.resize(fft_size / 2);
+        }
+    }
+}
+
+void MultiResolution::push(std::size_t row, std::span<const float> input) {
+    ASSERT(input.size() == hop_);
+    for (std::size_t level = 0; level < levels_; ++level) {
+        Lane& row_lane = lane(row, level);
+        const std::size_t size = hop_ >> level;
+        auto& history = row_lane.history;
+        std::copy(history.begin() + static_cast<std::ptrdiff_t>(size), history.end(), history.begin());
+        const auto output = std::span{ history }.last(size);
+
+        // every level decimates the full rate hop by itself, no level waits on the filter delay of another
+        if (row_lane.decimator.has_value()) {
+            row_lane.decimator->process(input, output);
+        } else {
+            std::copy(input.begin(), input.end(), output.begin());
+        }
+        row_lane.pending += size;
+    }
+}
+
+float MultiResolution::analyse(std::size_t row, std::span<float> normalized) {
+    ASSERT(normalized.size() == bins_);
+    const std::size_t fft_size = fft_->size();
+    const std::size_t half = fft_size / 2;
+    // in level k bins, level k + 1 takes over below 3/8 of the nyquist of level k, which is 3/4 of its own
+    const std::size_t crossover = fft_size * 3 / 16;
+
+    float level_sum = 0.0f;
+    for (std::size_t level = 0; level < levels_; ++level) {
+        Lane& row_lane = lane(row, level);
+        if (row_lane.pending >= hop_) { // same overlap at every level, so level k is due every 2^k hops
+            row_lane.pending = 0;
+            {
+                const perf::ScopedTimer timer{ perf::Stage::FFT };
+                // histories shift by a hop and are not windowed in place, so this is the one extra pass over S
+                const auto window = window_.coefficients();
+                if (window.empty()) {
+                    fft_->forward(row_lane.history, row_lane.freq_domain);
+                } else {
+                    for (std::size_t i = 0; i < fft_size; ++i) {
+                        row_lane.windowed[i] = row_lane.history[i] * window[i];
+                    }
+                    fft_->forward(row_lane.windowed, row_lane.freq_domain);
+                }
+            }
+            const perf::ScopedTimer timer{ perf::Stage::SPECTRUM };
+            // normalized by the full N like a single frame_count fft, the S point gain is made up for in the stitch
+            normalized_log_spectrum(row_lane.freq_domain, 2 * bins_, row_lane.normalized);
+        }
+
+        // STITCH: level bins [crossover, 2 crossover) are an octave, level bin j is output bin j * 2^shift
+        const std::size_t shift = levels_ - 1 - level;
+        const std::size_t first = level + 1 == levels_ ? 0 : crossover << shift;
+        const std::size_t last = level == 0 ? bins_ : (2 * crossover) << shift;
+        const float inv_scale = 1.0f / static_cast<float>(1uz << shift);
+        const auto& source = row_lane.normalized;
+        for (std::size_t bin = first; bin < last; ++bin) {
+            const std::size_t j = bin >> shift;
+            const float fraction = static_cast<float>(bin - (j << shift)) * inv_scale;
+            const float a = source[j];
+            const float b = source[std::min(j + 1, half - 1)];
+            const float value = a + (b - a) * fraction + log_gain_;
+            normalized[bin] = value;
+            level_sum += (value + 1.0f) * 0.5f;
+        }
+    }
+    return level_sum;
+}
+
+} // namespace audio
@@ -0,0 +1,116 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/offline.hpp"
+#include "audio/analyzer.hpp"
+#include "audio/deinterleave.hpp"
+#include "audio/file_source.hpp"
+
+#include <sl/meta/assert.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+namespace audio {
+
+sl::meta::result<OfflineFile, std::string> offline_prepare(
+    const std::filesystem::path& input,
+    const std::filesystem::path& output,
+    const DataConfig& analysis_config
+) {
+    return FileSource::open(input).and_then([&](auto&& source) -> sl::meta::result<OfflineFile, std::string> {
+        const NativeFormat native_format = source->native_format();
+        const DataConfig config = analysis_config.with_device_format(
+            native_format.format, native_format.channels, native_format.sample_rate
+        );
+        const ma_uint64 length = source->length();
+        if (length == 0) {
+            return sl::meta::err(fmt::format("{}: length is unknown", input.string()));
+        }
+
+        const SpectraHeader header{
+            .sample_rate = config.sample_rate,
+            .rows = static_cast<std::uint32_t>(planar_rows(config.capture_channels)),
+            .bins = static_cast<std::uint32_t>(config.frame_count / 2),
+            .frame_window = static_cast<std::uint32_t>(config.frame_window),
+            .hops = length < config.frame_count ? 0 : (length - config.frame_count) / config.frame_window + 1,
+        };
+
+        std::ofstream stream{ output, std::ios::binary | std::ios::trunc };
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (!stream) {
+            return sl::meta::err(fmt::format("{}: can not write", output.string()));
+        }
+        stream.close();
+        // records are written in place by offline_analyse, possibly out of order
+        std::error_code error;
+        std::filesystem::resize_file(output, header.file_size(), error);
+        if (error) {
+            return sl::meta::err(fmt::format("{}: {}", output.string(), error.message()));
+        }
+
+        return OfflineFile{
+            .input = input,
+            .output = output,
+            .config = config,
+            .header = header,
+        };
+    });
+}
+
+sl::meta::result<sl::meta::unit, std::string> offline_analyse(
+    const OfflineFile& file,
+    std::uint64_t first_hop,
+    std::uint64_t last_hop,
+    std::shared_ptr<const RealFft> fft
+) {
+    ASSERT(first_hop <= last_hop && last_hop <= file.header.hops);
+    if (first_hop == last_hop) {
+        return sl::meta::unit{};
+    }
+
+    return FileSource::open(file.input).and_then([&](auto&& source) -> sl::meta::result<sl::meta::unit, std::string> {
+        const DataConfig& config = file.config;
+        if (!source->seek(first_hop * config.frame_window)) {
+            return sl::meta::err(fmt::format("{}: can not seek to hop {}", file.input.string(), first_hop));
+        }
+
+        // exactly one window becomes available per feed, so the analyzer never skips a hop
+        DataCallback callback{ config, OverflowPolicy::DROP_NEWEST };
+        Analyzer analyzer{ config, std::move(fft), false };
+        Spectrum spectrum{ config };
+        std::vector<std::byte> decoded(config.frame_count * config.bytes_per_frame());
+        const auto feed = [&](std::size_t frame_count) {
+            const ma_uint64 frames_read = source->read(decoded, frame_count);
+            callback(std::span<const std::byte>{ decoded }.first(frames_read * config.bytes_per_frame()));
+            return frames_read == frame_count;
+        };
+
+        std::fstream stream{ file.output, std::ios::binary | std::ios::in | std::ios::out };
+        stream.seekp(static_cast<std::streamoff>(sizeof(SpectraHeader) + first_hop * file.header.record_size()));
+        std::vector<float> record(1 + spectrum.normalized.size());
+        const auto record_size = static_cast<std::streamsize>(record.size() * sizeof(float));
+
+        for (std::uint64_t hop = first_hop; hop < last_hop; ++hop) {
+            const bool is_fed = feed(hop == first_hop ? config.frame_count : config.frame_window);
+            if (!is_fed || !analyzer.update(callback, spectrum, false)) {
+                return sl::meta::err(fmt::format("{}: ended early at hop {}", file.input.string(), hop));
+            }
+
+            const float level = spectrum.level_sums[0] / static_cast<float>(config.frame_count);
+            record[0] = std::clamp(level, 0.0f, 1.0f);
+            std::copy(spectrum.normalized.begin(), spectrum.normalized.end(), record.begin() + 1);
+            stream.write(reinterpret_cast<const char*>(record.data()), record_size);
+        }
+        if (!stream) {
+            return sl::meta::err(fmt::format("{}: can not write", file.output.string()));
+        }
+        return sl::meta::unit{};
+    });
+}
+
+} // namespace audio
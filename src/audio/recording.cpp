@@ -0,0 +1,339 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/recording.hpp"
+
+#include <sl/meta/assert.hpp>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+
+namespace audio {
+namespace {
+
+constexpr std::uint16_t level_max = 0xffff;
+
+constexpr std::uint16_t quantization_max(Quantization quantization) {
+    return quantization == Quantization::U8 ? std::uint16_t{ 0xff } : std::uint16_t{ 0xffff };
+}
+
+std::uint16_t quantize(float value, std::uint16_t max) {
+    const float unit = (std::clamp(value, -1.0f, 1.0f) + 1.0f) * 0.5f;
+    return static_cast<std::uint16_t>(std::lround(unit * static_cast<float>(max)));
+}
+
+float dequantize(std::uint16_t value, std::uint16_t max) {
+    return static_cast<float>(value) * (2.0f / static_cast<float>(max)) - 1.0f;
+}
+
+constexpr std::uint64_t zigzag(std::int64_t value) {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+constexpr std::int64_t unzigzag(std::uint64_t value) {
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+void put_varint(std::vector<std::byte>& output, std::uint64_t value) {
+    while (value >= 0x80) {
+        output.push_back(static_cast<std::byte>(value | 0x80));
+        value >>= 7;
+    }
+    output.push_back(static_cast<std::byte>(value));
+}
+
+void put_fixed(std::vector<std::byte>& output, std::uint64_t value, std::size_t bytes) {
+    for (std::size_t i = 0; i < bytes; ++i) {
+        output.push_back(static_cast<std::byte>(value >> (8 * i)));
+    }
+}
+
+// readers are given untrusted input, nullopt if it ends early or the varint is longer than 64 bits
+std::optional<std::uint64_t> get_varint(std::span<const std::byte> input, std::size_t& offset) {
+    std::uint64_t value = 0;
+    for (std::size_t shift = 0; shift < 64 && offset < input.size(); shift += 7) {
+        const auto byte = std::to_integer<std::uint64_t>(input[offset++]);
+        value |= (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<std::uint64_t> get_fixed(std::span<const std::byte> input, std::size_t& offset, std::size_t bytes) {
+    if (offset > input.size() || bytes > input.size() - offset) {
+        return std::nullopt;
+    }
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < bytes; ++i) {
+        value |= std::to_integer<std::uint64_t>(input[offset++]) << (8 * i);
+    }
+    return value;
+}
+
+void put_header(std::vector<std::byte>& output, const RecordingHeader& header) {
+    for (const char c : header.magic) {
+        output.push_back(static_cast<std::byte>(c));
+    }
+    put_fixed(output, header.version, sizeof(header.version));
+    put_fixed(output, header.rows, sizeof(header.rows));
+    put_fixed(output, header.bins, sizeof(header.bins));
+    put_fixed(output, static_cast<std::uint32_t>(header.quantization), sizeof(std::uint32_t));
+    put_fixed(output, header.keyframe_interval, sizeof(header.keyframe_interval));
+    put_fixed(output, header.frame_count, sizeof(header.frame_count));
+    put_fixed(output, header.index_offset, sizeof(header.index_offset));
+}
+
+// input has at least RecordingHeader::encoded_size bytes
+RecordingHeader get_header(std::span<const std::byte> input) {
+    RecordingHeader header{};
+    std::size_t offset = 0;
+    for (char& c : header.magic) {
+        c = static_cast<char>(input[offset++]);
+    }
+    const auto get_u32 = [&] { return static_cast<std::uint32_t>(*get_fixed(input, offset, sizeof(std::uint32_t))); };
+    const auto get_u64 = [&] { return *get_fixed(input, offset, sizeof(std::uint64_t)); };
+    header.version = get_u32();
+    header.rows = get_u32();
+    header.bins = get_u32();
+    header.quantization = static_cast<Quantization>(get_u32());
+    header.keyframe_interval = get_u32();
+    header.frame_count = get_u64();
+    header.index_offset = get_u64();
+    ASSERT(offset == RecordingHeader::encoded_size);
+    return header;
+}
+
+void write_bytes(std::ofstream& stream, std::span<const std::byte> bytes) {
+    stream.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+} // namespace
+
+sl::meta::result<std::unique_ptr<SpectrumRecorder>, std::string> SpectrumRecorder::create(
+    const std::filesystem::path& path,
+    std::size_t rows,
+    std::size_t bins,
+    Quantization quantization,
+    std::uint32_t keyframe_interval
+) {
+    ASSERT(keyframe_interval > 0);
+    std::ofstream stream{ path, std::ios::binary | std::ios::trunc };
+    const RecordingHeader header{
+        .rows = static_cast<std::uint32_t>(rows),
+        .bins = static_cast<std::uint32_t>(bins),
+        .quantization = quantization,
+        .keyframe_interval = keyframe_interval,
+    };
+    // placeholder until close knows frame count and index offset
+    std::vector<std::byte> encoded;
+    put_header(encoded, header);
+    write_bytes(stream, encoded);
+    if (!stream) {
+        return sl::meta::err(fmt::format("{}: can not write", path.string()));
+    }
+    return std::unique_ptr<SpectrumRecorder>{ new SpectrumRecorder{ path, std::move(stream), header } };
+}
+
+SpectrumRecorder::SpectrumRecorder(std::filesystem::path path, std::ofstream stream, const RecordingHeader& header)
+    : path_{ std::move(path) }, //
+      stream_{ std::move(stream) }, //
+      header_{ header }, //
+      previous_(header.values()), //
+      current_(header.values()) {
+    index_.reserve(reserved_keyframes);
+}
+
+SpectrumRecorder::~SpectrumRecorder() {
+    if (is_closed_) {
+        return;
+    }
+    close().map_error([](const std::string& error) {
+        spdlog::error("[recording] {}", error);
+        return error;
+    });
+}
+
+sl::meta::result<sl::meta::unit, std::string> SpectrumRecorder::close() {
+    ASSERT(!is_closed_);
+    is_closed_ = true;
+
+    encoded_.clear();
+    for (const auto& [offset, timestamp] : index_) {
+        put_fixed(encoded_, offset, sizeof(offset));
+        put_fixed(encoded_, timestamp, sizeof(timestamp));
+    }
+    write_bytes(stream_, encoded_);
+
+    header_.index_offset = offset_;
+    encoded_.clear();
+    put_header(encoded_, header_);
+    stream_.seekp(0);
+    write_bytes(stream_, encoded_);
+    stream_.close();
+    // failbit is sticky, so this also catches a failed write of any frame
+    if (!stream_) {
+        return sl::meta::err(fmt::format("{}: can not write, the recording is incomplete", path_.string()));
+    }
+    return sl::meta::unit{};
+}
+
+void SpectrumRecorder::write(std::chrono::nanoseconds timestamp, float sound_level, std::span<const float> normalized) {
+    ASSERT(!is_closed_ && normalized.size() == header_.values());
+    const bool is_keyframe = header_.frame_count % header_.keyframe_interval == 0;
+    const std::uint16_t max = quantization_max(header_.quantization);
+    const auto value_bytes = static_cast<std::size_t>(header_.quantization);
+
+    encoded_.clear();
+    if (is_keyframe) {
+        index_.push_back({ offset_, static_cast<std::uint64_t>(timestamp.count()) });
+        put_varint(encoded_, static_cast<std::uint64_t>(timestamp.count()));
+    } else {
+        put_varint(encoded_, static_cast<std::uint64_t>(std::max(timestamp - previous_timestamp_, {}).count()));
+    }
+    previous_timestamp_ = timestamp;
+
+    const float unit_level = std::clamp(sound_level, 0.0f, 1.0f);
+    put_fixed(encoded_, static_cast<std::uint64_t>(std::lround(unit_level * level_max)), sizeof(level_max));
+
+    std::transform(normalized.begin(), normalized.end(), current_.begin(), [max](float value) {
+        return quantize(value, max);
+    });
+    for (std::size_t i = 0; i < current_.size(); ++i) {
+        if (is_keyframe) {
+            put_fixed(encoded_, current_[i], value_bytes);
+        } else {
+            put_varint(encoded_, zigzag(std::int64_t{ current_[i] } - std::int64_t{ previous_[i] }));
+        }
+    }
+    std::swap(previous_, current_);
+
+    write_bytes(stream_, encoded_);
+    offset_ += encoded_.size();
+    ++header_.frame_count;
+}
+
+sl::meta::result<SpectrumRecording, std::string> SpectrumRecording::open(const std::filesystem::path& path) {
+    return MappedFile::open(path)
+        .map_error([&](const std::error_code& error) { return fmt::format("{}: {}", path.string(), error.message()); })
+        .and_then([&](auto&& file) -> sl::meta::result<SpectrumRecording, std::string> {
+            const std::span<const std::byte> data = file.data();
+            if (data.size() < RecordingHeader::encoded_size) {
+                return sl::meta::err(fmt::format("{}: not a recording", path.string()));
+            }
+            const RecordingHeader header = get_header(data);
+            if (header.magic != RecordingHeader::expected_magic
+                || header.version != RecordingHeader::expected_version) {
+                return sl::meta::err(fmt::format("{}: not a recording", path.string()));
+            }
+            if (header.keyframe_interval == 0
+                || (header.quantization != Quantization::U8 && header.quantization != Quantization::U16)) {
+                return sl::meta::err(fmt::format("{}: corrupt header", path.string()));
+            }
+            // frames are checked as they are decoded, the index only as far as its size
+            const std::uint64_t keyframes = (header.frame_count - 1) / header.keyframe_interval + 1;
+            if (header.frame_count == 0 || header.index_offset < RecordingHeader::encoded_size
+                || header.index_offset > data.size()
+                || keyframes > (data.size() - header.index_offset) / (2 * sizeof(std::uint64_t))) {
+                return sl::meta::err(fmt::format("{}: recording is empty or was not closed", path.string()));
+            }
+            // the first keyframe has to fit, which also bounds what rows x bins allocate
+            const std::uint64_t keyframe_size = header.values() * static_cast<std::size_t>(header.quantization);
+            if (keyframe_size > header.index_offset - RecordingHeader::encoded_size) {
+                return sl::meta::err(fmt::format("{}: corrupt header", path.string()));
+            }
+            return SpectrumRecording{ std::move(file), header };
+        });
+}
+
+SpectrumRecording::SpectrumRecording(MappedFile file, const RecordingHeader& header)
+    : file_{ std::move(file) }, //
+      header_{ header }, //
+      index_{ file_.data().subspan(header.index_offset) }, //
+      previous_(header.values()), //
+      decoded_(header.values()) {
+    scratch_.normalized.resize(header.values());
+}
+
+sl::meta::result<bool, std::string> SpectrumRecording::next(RecordedFrame& frame) {
+    if (position_ >= header_.frame_count) {
+        return false;
+    }
+    const std::span<const std::byte> frames = file_.data().first(header_.index_offset);
+    const bool is_keyframe = position_ % header_.keyframe_interval == 0;
+    const std::uint16_t max = quantization_max(header_.quantization);
+    const auto value_bytes = static_cast<std::size_t>(header_.quantization);
+    const auto corrupt = [this] { return sl::meta::err(fmt::format("frame {} is truncated or corrupt", position_)); };
+
+    // nothing is committed before the whole frame is decoded, so a corrupt one leaves frame and state as they were
+    std::size_t offset = offset_;
+    const auto maybe_timestamp = get_varint(frames, offset);
+    const auto maybe_level = get_fixed(frames, offset, sizeof(level_max));
+    // timestamps never decrease and start at 0, so previous_timestamp_ is never negative
+    const std::uint64_t timestamp_base = is_keyframe ? 0 : static_cast<std::uint64_t>(previous_timestamp_.count());
+    constexpr auto max_timestamp = static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max());
+    if (!maybe_timestamp.has_value() || !maybe_level.has_value() || *maybe_timestamp > max_timestamp - timestamp_base) {
+        return corrupt();
+    }
+    for (std::size_t i = 0; i < previous_.size(); ++i) {
+        std::int64_t value = 0;
+        if (is_keyframe) {
+            const auto maybe_value = get_fixed(frames, offset, value_bytes);
+            if (!maybe_value.has_value()) {
+                return corrupt();
+            }
+            value = static_cast<std::int64_t>(*maybe_value);
+        } else {
+            const auto maybe_delta = get_varint(frames, offset);
+            if (!maybe_delta.has_value() || *maybe_delta > 2 * std::uint64_t{ max }) { // zigzag of +-max
+                return corrupt();
+            }
+            value = std::int64_t{ previous_[i] } + unzigzag(*maybe_delta);
+        }
+        if (value < 0 || value > max) {
+            return corrupt();
+        }
+        decoded_[i] = static_cast<std::uint16_t>(value);
+    }
+    std::swap(previous_, decoded_);
+
+    frame.timestamp = std::chrono::nanoseconds{ static_cast<std::int64_t>(timestamp_base + *maybe_timestamp) };
+    frame.sound_level = static_cast<float>(*maybe_level) / level_max;
+    frame.normalized.resize(previous_.size());
+    std::transform(previous_.begin(), previous_.end(), frame.normalized.begin(), [max](std::uint16_t value) {
+        return dequantize(value, max);
+    });
+    previous_timestamp_ = frame.timestamp;
+    offset_ = offset;
+    ++position_;
+    return true;
+}
+
+sl::meta::result<sl::meta::unit, std::string> SpectrumRecording::seek(std::uint64_t frame_index) {
+    frame_index = std::min(frame_index, header_.frame_count);
+    const std::uint64_t keyframe = std::min(frame_index, header_.frame_count - 1) / header_.keyframe_interval;
+    // in bounds, open checked the size of the index
+    std::size_t index_offset = static_cast<std::size_t>(keyframe * 2 * sizeof(std::uint64_t));
+    const std::uint64_t keyframe_offset = *get_fixed(index_, index_offset, sizeof(std::uint64_t));
+    if (keyframe_offset < RecordingHeader::encoded_size || keyframe_offset >= header_.index_offset) {
+        return sl::meta::err(fmt::format("keyframe {} points outside of the frames", keyframe));
+    }
+    offset_ = static_cast<std::size_t>(keyframe_offset);
+    position_ = keyframe * header_.keyframe_interval;
+    while (position_ < frame_index) {
+        auto decoded = next(scratch_);
+        if (!decoded) {
+            return sl::meta::err(std::move(decoded.error()));
+        }
+    }
+    return sl::meta::unit{};
+}
+
+} // namespace audio
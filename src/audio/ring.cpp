@@ -0,0 +1,127 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/ring.hpp"
+
+#include <sl/meta/assert.hpp>
+
+#include <algorithm>
+#include <bit>
+
+namespace audio {
+
+Ring::Ring(std::size_t min_capacity, std::size_t max_read, std::size_t granularity, OverflowPolicy overflow_policy)
+    : capacity_{ std::bit_ceil(std::max(min_capacity, max_read)) }, //
+      mask_{ capacity_ - 1 }, //
+      max_read_{ max_read }, //
+      granularity_{ granularity }, //
+      overflow_policy_{ overflow_policy }, //
+      data_{ std::make_unique<std::byte[]>(capacity_ + max_read_) } {
+    ASSERT(max_read_ > 0 && granularity_ > 0 && max_read_ % granularity_ == 0);
+}
+
+std::uint64_t Ring::push(std::span<const std::byte> input) {
+    // capacity is a power of two, granularity is a frame size, so the whole ring is not always usable
+    const std::size_t usable_capacity = floor_to_granularity(capacity_);
+
+    std::uint64_t dropped = 0;
+    if (input.size() > usable_capacity) {
+        dropped += input.size() - usable_capacity;
+        input = overflow_policy_ == OverflowPolicy::DROP_OLDEST ? input.last(usable_capacity)
+                                                                 : input.first(usable_capacity);
+    }
+
+    const std::uint64_t write = write_.value.load(std::memory_order::relaxed);
+    std::uint64_t read = read_.value.load(std::memory_order::acquire);
+    const std::size_t free = usable_capacity - static_cast<std::size_t>(write - read);
+
+    if (free < input.size()) {
+        switch (overflow_policy_) {
+        case OverflowPolicy::DROP_OLDEST: {
+            const std::uint64_t reclaim_to = write + input.size() - usable_capacity;
+            while (read < reclaim_to) {
+                if (read_.value.compare_exchange_weak(read, reclaim_to, std::memory_order::acq_rel)) {
+                    dropped += reclaim_to - read;
+                    break;
+                }
+            }
+            break;
+        }
+        case OverflowPolicy::DROP_NEWEST:
+            dropped += input.size() - floor_to_granularity(free);
+            input = input.first(floor_to_granularity(free));
+            break;
+        }
+    }
+
+    const std::size_t index = write & mask_;
+    const std::size_t head_size = std::min(input.size(), capacity_ - index);
+    write_at(index, input.first(head_size));
+    write_at(0, input.subspan(head_size));
+    write_.value.store(write + input.size(), std::memory_order::release);
+
+    if (dropped > 0) {
+        dropped_.value.fetch_add(dropped, std::memory_order::relaxed);
+    }
+    return write + input.size();
+}
+
+std::size_t Ring::skip_stale(std::size_t size, std::size_t advance, std::size_t keep) {
+    ASSERT(advance > 0 && keep > 0);
+    while (true) {
+        std::uint64_t read = read_.value.load(std::memory_order::acquire);
+        const std::uint64_t write = write_.value.load(std::memory_order::acquire);
+        if (read > write || write - read > capacity_) { // producer has reclaimed in between the loads
+            continue;
+        }
+        const auto available = static_cast<std::size_t>(write - read);
+        if (available < size) {
+            return 0;
+        }
+        const std::size_t reads = (available - size) / advance + 1;
+        if (reads <= keep) {
+            return 0;
+        }
+        const std::size_t skip = (reads - keep) * advance;
+        // fails only if producer has reclaimed meanwhile, then the remaining backlog is recounted
+        if (read_.value.compare_exchange_strong(read, read + skip, std::memory_order::release)) {
+            skipped_.value.fetch_add(skip, std::memory_order::relaxed);
+            return skip;
+        }
+    }
+}
+
+std::size_t Ring::available() const {
+    const std::uint64_t read = read_.value.load(std::memory_order::acquire);
+    const std::uint64_t write = write_.value.load(std::memory_order::acquire);
+    return static_cast<std::size_t>(write - std::min(read, write));
+}
+
+std::optional<std::uint64_t> Ring::try_acquire(std::size_t size) const {
+    ASSERT(size <= max_read_);
+    while (true) {
+        const std::uint64_t read = read_.value.load(std::memory_order::acquire);
+        const std::uint64_t write = write_.value.load(std::memory_order::acquire);
+        if (read > write || write - read > capacity_) { // producer has reclaimed in between the loads
+            continue;
+        }
+        if (write - read < size) {
+            return std::nullopt;
+        }
+        return read;
+    }
+}
+
+void Ring::write_at(std::size_t index, std::span<const std::byte> input) {
+    if (input.empty()) {
+        return;
+    }
+    std::copy(input.begin(), input.end(), data_.get() + index);
+    if (index < max_read_) { // mirror the head past the end
+        const std::size_t mirror_size = std::min(input.size(), max_read_ - index);
+        std::copy_n(input.begin(), mirror_size, data_.get() + capacity_ + index);
+    }
+}
+
+} // namespace audio
@@ -0,0 +1,72 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/spectrum.hpp"
+
+#include <sl/meta/assert.hpp>
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <numeric>
+
+namespace audio {
+namespace {
+
+// branchless ln for normal x > 0, unlike std::log it is vectorized by the compiler
+// measured over every float: absolute error below 1.3e-6 + 1.2e-7 |ln x|, the second term is the rounding of
+// exponent * ln 2, for the mantissa alone that is 1.25e-6 at most
+inline float fast_ln(float x) {
+    const auto bits = std::bit_cast<std::uint32_t>(x);
+    const auto exponent = static_cast<float>(static_cast<std::int32_t>(bits >> 23) - 127);
+    const float mantissa = std::bit_cast<float>((bits & 0x007f'ffffu) | 0x3f80'0000u); // [1, 2)
+
+    // ln m = 2 atanh t, t = (m - 1) / (m + 1) in [0, 1/3)
+    const float t = (mantissa - 1.0f) / (mantissa + 1.0f);
+    const float t2 = t * t;
+    const float atanh_t =
+        t * (1.0f + t2 * (1.0f / 3.0f + t2 * (1.0f / 5.0f + t2 * (1.0f / 7.0f + t2 * (1.0f / 9.0f)))));
+    return exponent * std::numbers::ln2_v<float> + 2.0f * atanh_t;
+}
+
+} // namespace
+
+float normalized_log_spectrum(
+    std::span<const std::complex<float>> bins,
+    std::size_t fft_size,
+    std::span<float> output
+) {
+    ASSERT(bins.size() >= output.size());
+
+    // ln |X| / ln N == ln |X|^2 / (2 ln N), so no sqrt is needed
+    const float scale = 1.0f / (2.0f * std::log(static_cast<float>(fft_size)));
+    const auto kernel = [scale](std::complex<float> x) {
+        return fast_ln(x.real() * x.real() + x.imag() * x.imag()) * scale;
+    };
+
+    // independent lanes let the compiler keep the reduction in a vector register
+    constexpr std::size_t lanes = 8;
+    std::array<float, lanes> acc{};
+
+    const std::size_t size = output.size();
+    const std::size_t blocked_size = size - size % lanes;
+    for (std::size_t i = 0; i < blocked_size; i += lanes) {
+        for (std::size_t lane = 0; lane < lanes; ++lane) {
+            const float value = kernel(bins[i + lane]);
+            output[i + lane] = value;
+            acc[lane] += (value + 1.0f) * 0.5f;
+        }
+    }
+    for (std::size_t i = blocked_size; i < size; ++i) {
+        const float value = kernel(bins[i]);
+        output[i] = value;
+        acc[0] += (value + 1.0f) * 0.5f;
+    }
+
+    return std::accumulate(acc.begin(), acc.end(), 0.0f);
+}
+
+} // namespace audio
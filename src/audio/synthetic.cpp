@@ -0,0 +1,59 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/synthetic.hpp"
+#include "audio/pacer.hpp"
+#include "perf/realtime.hpp"
+#include "perf/trace.hpp"
+
+#include <sl/meta/assert.hpp>
+
+#include <algorithm>
+
+namespace audio {
+
+SyntheticSource::SyntheticSource(const DataConfig& data_config, const SyntheticConfig& config)
+    : config_{ config }, //
+      bytes_per_frame_{ data_config.bytes_per_frame() }, //
+      period_(config.period_frames * data_config.bytes_per_frame()) {
+    ASSERT(config_.period_frames > 0);
+    const ma_waveform_config waveform_config = ma_waveform_config_init(
+        data_config.format,
+        data_config.capture_channels,
+        data_config.sample_rate,
+        config_.waveform,
+        config_.amplitude,
+        config_.frequency
+    );
+    ASSERT(ma_waveform_init(&waveform_config, &waveform_) == MA_SUCCESS);
+}
+
+void SyntheticSource::feed(DataCallback& callback, std::size_t frame_count) {
+    while (frame_count > 0) {
+        const std::size_t period_frames = std::min<std::size_t>(frame_count, config_.period_frames);
+        ma_waveform_read_pcm_frames(&waveform_, period_.data(), period_frames, nullptr);
+        const perf::realtime::Section realtime;
+        callback(std::span<const std::byte>{ period_ }.first(period_frames * bytes_per_frame_));
+        frame_count -= period_frames;
+    }
+}
+
+SyntheticDevice::SyntheticDevice(const DataConfig& data_config, const SyntheticConfig& config, DataCallback& callback)
+    : source_{ data_config, config }, //
+      sample_rate_{ data_config.sample_rate }, //
+      thread_{ [this, &callback](std::stop_token stop_token) { run(std::move(stop_token), callback); } } {}
+
+void SyntheticDevice::run(std::stop_token stop_token, DataCallback& callback) {
+    perf::trace::name_thread("synthetic device");
+    const SyntheticConfig& config = source_.config();
+    Pacer pacer{ config.period_frames, sample_rate_, config.speed };
+    while (!stop_token.stop_requested()) {
+        source_.feed(callback, config.period_frames);
+        generated_frames_.fetch_add(config.period_frames, std::memory_order::relaxed);
+        pacer.wait();
+    }
+    perf::trace::release_thread("synthetic device");
+}
+
+} // namespace audio
@@ -0,0 +1,135 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/window.hpp"
+
+#include <sl/meta/assert.hpp>
+
+#include <array>
+#include <bit>
+#include <numbers>
+#include <utility>
+
+namespace audio {
+namespace {
+
+// std::cos is not constexpr, the angle is reduced to [-pi, pi) exactly through the integer phase index,
+// where the series converges to well below float precision
+constexpr double constexpr_cos(std::size_t index, std::size_t size) {
+    const double turn = static_cast<double>(index % size) / static_cast<double>(size);
+    const double x = 2.0 * std::numbers::pi * (turn < 0.5 ? turn : turn - 1.0);
+    const double x2 = x * x;
+    double term = 1.0;
+    double sum = 1.0;
+    for (int k = 1; k < 16; ++k) {
+        term *= -x2 / static_cast<double>((2 * k - 1) * (2 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+struct CosineSum {
+    std::array<double, 5> a; // a0 - a1 cos(x) + a2 cos(2x) - a3 cos(3x) + a4 cos(4x)
+};
+
+constexpr CosineSum cosine_sum(WindowFunction function) {
+    switch (function) {
+    case WindowFunction::HANN:
+        return { { 0.5, 0.5, 0.0, 0.0, 0.0 } };
+    case WindowFunction::HAMMING:
+        return { { 0.54, 0.46, 0.0, 0.0, 0.0 } };
+    case WindowFunction::BLACKMAN_HARRIS:
+        return { { 0.35875, 0.48829, 0.14128, 0.01168, 0.0 } };
+    case WindowFunction::FLAT_TOP:
+        return { { 0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368 } };
+    default:
+        break;
+    }
+    return { { 1.0, 0.0, 0.0, 0.0, 0.0 } };
+}
+
+// periodic (dft-even), divided by a0 which is the mean of every cosine-sum window
+// cos(k x) comes from cos(x) by the chebyshev recurrence, so there is one series per coefficient
+constexpr float window_coefficient(WindowFunction function, std::size_t n, std::size_t size) {
+    const CosineSum cs = cosine_sum(function);
+    const double c = constexpr_cos(n, size);
+    double value = cs.a[0];
+    double sign = -1.0;
+    double cos_prev = 1.0;
+    double cos_k = c;
+    for (std::size_t k = 1; k < cs.a.size(); ++k) {
+        value += sign * cs.a[k] * cos_k;
+        sign = -sign;
+        const double cos_next = 2.0 * c * cos_k - cos_prev;
+        cos_prev = cos_k;
+        cos_k = cos_next;
+    }
+    return static_cast<float>(value / cs.a[0]);
+}
+
+template <WindowFunction function, std::size_t size>
+constexpr std::array<float, size> make_table() {
+    std::array<float, size> table{};
+    for (std::size_t n = 0; n < size; ++n) {
+        table[n] = window_coefficient(function, n, size);
+    }
+    return table;
+}
+
+template <WindowFunction function, std::size_t size>
+constexpr std::array<float, size> window_table = make_table<function, size>();
+
+static_assert(window_table<WindowFunction::HANN, 64>[0] == 0.0f);
+static_assert(window_table<WindowFunction::HANN, 64>[32] == 2.0f);
+
+// every power of two from min_table_size to max_table_size
+constexpr std::size_t table_sizes =
+    std::bit_width(Window::max_table_size) - std::bit_width(Window::min_table_size) + 1;
+
+template <WindowFunction function, std::size_t... exponents>
+std::span<const float> find_table(std::size_t size, std::index_sequence<exponents...>) {
+    std::span<const float> found;
+    ((size == (Window::min_table_size << exponents)
+          ? void(found = window_table<function, (Window::min_table_size << exponents)>)
+          : void()),
+     ...);
+    return found;
+}
+
+std::span<const float> find_table(WindowFunction function, std::size_t size) {
+    constexpr auto exponents = std::make_index_sequence<table_sizes>{};
+    switch (function) {
+    case WindowFunction::HANN:
+        return find_table<WindowFunction::HANN>(size, exponents);
+    case WindowFunction::HAMMING:
+        return find_table<WindowFunction::HAMMING>(size, exponents);
+    case WindowFunction::BLACKMAN_HARRIS:
+        return find_table<WindowFunction::BLACKMAN_HARRIS>(size, exponents);
+    case WindowFunction::FLAT_TOP:
+        return find_table<WindowFunction::FLAT_TOP>(size, exponents);
+    default:
+        break;
+    }
+    return {};
+}
+
+} // namespace
+
+Window::Window(WindowFunction function, std::size_t size) : function_{ function }, size_{ size } {
+    ASSERT(std::has_single_bit(size_));
+    if (function_ == WindowFunction::RECTANGULAR) {
+        return;
+    }
+    coefficients_ = find_table(function_, size_);
+    if (!coefficients_.empty()) {
+        return;
+    }
+    computed_.resize(size_);
+    for (std::size_t n = 0; n < size_; ++n) {
+        computed_[n] = window_coefficient(function_, n, size_);
+    }
+    coefficients_ = computed_;
+}
+
+} // namespace audio
@@ -0,0 +1,46 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/worker.hpp"
+
+#include "perf/trace.hpp"
+
+namespace audio {
+
+AnalysisWorker::AnalysisWorker(const DataConfig& config, DataCallback& callback, Analyzer& analyzer)
+    : spectra_{ Spectrum{ config, analyzer.bins() } },
+      // a few polls per hop keep the latency well below the hop duration while the thread mostly sleeps
+      poll_period_{ std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::duration<double>{ static_cast<double>(analyzer.hop()) / config.sample_rate / 4.0 }
+      ) },
+      thread_{ [this, &callback, &analyzer](std::stop_token stop_token) {
+          run(std::move(stop_token), callback, analyzer);
+      } } {}
+
+const Spectrum& AnalysisWorker::latest() {
+    spectra_.update();
+    return spectra_.front();
+}
+
+void AnalysisWorker::run(std::stop_token stop_token, DataCallback& callback, Analyzer& analyzer) {
+    perf::trace::name_thread("analysis worker");
+    while (!stop_token.stop_requested()) {
+        const bool take_snapshot = snapshot_requested_.load(std::memory_order::relaxed);
+        const bool is_updated = [&] {
+            const perf::trace::Scope trace{ "analysis" };
+            return analyzer.update(callback, spectra_.back(), take_snapshot);
+        }();
+        if (!is_updated) {
+            std::this_thread::sleep_for(poll_period_);
+            continue;
+        }
+        if (take_snapshot) {
+            snapshot_requested_.store(false, std::memory_order::relaxed);
+        }
+        spectra_.publish();
+    }
+    perf::trace::release_thread("analysis worker");
+}
+
+} // namespace audio
@@ -4,6 +4,8 @@
 
 #include "visualizer/scene.hpp"
 
+#include "perf/trace.hpp"
+
 #include <sl/ecs.hpp>
 #include <sl/exec.hpp>
 #include <sl/game.hpp>
@@ -19,6 +21,9 @@ int main(int argc, char** argv) {
     sl::gfx::logger().set_level(spdlog::level::debug);
     sl::gfx::logger().sinks().push_back(a_logger);
 
+    perf::trace::enable_from_environment();
+    perf::trace::name_thread("main");
+
     const glm::ivec2 window_size{ 1280, 720 };
     auto w_ctx = *ASSERT_VAL(sl::game::window_context::initialize(
         sl::gfx::context::options{ 3, 3, GLFW_OPENGL_CORE_PROFILE },
@@ -35,9 +40,14 @@ int main(int argc, char** argv) {
     sl::exec::coro_schedule(*e_ctx.script_exec, visualizer::create_scene(e_ctx, layer, gfx_system.world, window_size));
 
     while (e_ctx.is_ok()) {
-        while (e_ctx.script_exec->execute_batch() > 0) {}
+        {
+            const perf::trace::Scope trace{ "script executor" };
+            while (e_ctx.script_exec->execute_batch() > 0) {}
+        }
+        const perf::trace::Scope trace{ "frame" };
         e_ctx.spin_once(layer, gfx_system, overlay_system);
     }
 
     while (e_ctx.script_exec->execute_batch() > 0) {}
+    perf::trace::dump();
 }
@@ -0,0 +1,164 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/fft.hpp"
+#include "audio/fork_join.hpp"
+#include "audio/offline.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// analyses audio files into spectra files (see audio::SpectraHeader) with no window and no real-time pacing
+// every file is split into chunks of hops, chunks of all files are analysed in parallel
+int main(int argc, char** argv) {
+    constexpr std::string_view usage =
+        "usage: serious-music-visualizer-offline [--fft N] [--hop N] [--chunk HOPS] [--threads N] -o DIR FILE...";
+
+    std::size_t frame_count = 1024 * 2;
+    std::size_t frame_window = 1024;
+    std::uint64_t chunk_hops = 1024;
+    std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::filesystem::path output_dir = ".";
+    std::vector<std::filesystem::path> inputs;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        // a missing or malformed value ends parsing, which is then reported like any other invalid argument
+        bool is_valid = true;
+        const auto next_value = [&]() -> std::optional<std::string_view> {
+            if (i + 1 >= argc) {
+                return std::nullopt;
+            }
+            return argv[++i];
+        };
+        const auto next_number = [&](auto& number) {
+            const auto value = next_value();
+            if (!value.has_value()) {
+                is_valid = false;
+                return;
+            }
+            const auto [end, error] = std::from_chars(value->data(), value->data() + value->size(), number);
+            is_valid = error == std::errc{} && end == value->data() + value->size();
+        };
+        if (arg == "--fft") {
+            next_number(frame_count);
+        } else if (arg == "--hop") {
+            next_number(frame_window);
+        } else if (arg == "--chunk") {
+            next_number(chunk_hops);
+        } else if (arg == "--threads") {
+            next_number(threads);
+        } else if (arg == "-o") {
+            const auto value = next_value();
+            is_valid = value.has_value();
+            output_dir = value.value_or(".");
+        } else if (arg == "-h" || arg == "--help") {
+            fmt::println("{}", usage);
+            return 0;
+        } else {
+            inputs.emplace_back(arg);
+        }
+        if (!is_valid) {
+            fmt::println(stderr, "{}", usage);
+            return 1;
+        }
+    }
+    if (inputs.empty() || frame_count == 0 || (frame_count & (frame_count - 1)) != 0 || frame_window == 0
+        || frame_window > frame_count || chunk_hops == 0 || threads == 0) {
+        fmt::println(stderr, "{}", usage);
+        return 1;
+    }
+    std::filesystem::create_directories(output_dir);
+
+    // channels, format and sample rate are taken from every file
+    const audio::DataConfig analysis_config{ 2, 48000, frame_count, frame_count * 2, frame_window };
+
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+
+    // outputs are flat in output_dir, an input whose output is already taken is rejected before anything is written
+    std::vector<audio::OfflineFile> files;
+    std::vector<std::pair<std::filesystem::path, std::filesystem::path>> taken_outputs; // output, input
+    double total_seconds = 0.0;
+    for (const auto& input : inputs) {
+        const auto output = output_dir / input.filename().replace_extension(".spectra");
+        const auto taken = std::ranges::find_if(taken_outputs, [&output](const auto& taken) {
+            return taken.first == output;
+        });
+        if (taken != taken_outputs.end()) {
+            fmt::println(
+                stderr, "{}: output {} is already taken by {}", input.string(), output.string(), taken->second.string()
+            );
+            continue;
+        }
+        taken_outputs.emplace_back(output, input);
+
+        auto maybe_file = audio::offline_prepare(input, output, analysis_config);
+        if (!maybe_file) {
+            fmt::println(stderr, "{}", maybe_file.error());
+            continue;
+        }
+        const audio::OfflineFile& file = files.emplace_back(std::move(*maybe_file));
+        total_seconds += static_cast<double>(file.header.hops * file.config.frame_window) / file.config.sample_rate;
+    }
+
+    struct Chunk {
+        std::size_t file_index;
+        std::uint64_t first_hop;
+        std::uint64_t last_hop;
+    };
+    std::vector<Chunk> chunks;
+    for (std::size_t file_index = 0; file_index < files.size(); ++file_index) {
+        const std::uint64_t hops = files[file_index].header.hops;
+        for (std::uint64_t first_hop = 0; first_hop < hops; first_hop += chunk_hops) {
+            chunks.push_back(Chunk{ file_index, first_hop, std::min(first_hop + chunk_hops, hops) });
+        }
+    }
+
+    // fft plans are immutable, one is shared by every chunk
+    audio::FftPlanCache fft_plans;
+    const auto fft = fft_plans.real(frame_count);
+    std::vector<std::optional<std::string>> errors(chunks.size());
+    auto analyse_chunk = [&](std::size_t chunk_index) {
+        const Chunk& chunk = chunks[chunk_index];
+        auto analysed = audio::offline_analyse(files[chunk.file_index], chunk.first_hop, chunk.last_hop, fft);
+        if (!analysed) {
+            errors[chunk_index] = std::move(analysed.error());
+        }
+    };
+    {
+        audio::ForkJoin pool{ threads - 1 };
+        pool.run(chunks.size(), analyse_chunk);
+    }
+
+    int exit_code = files.size() == inputs.size() ? 0 : 1;
+    for (const auto& error : errors) {
+        if (error.has_value()) {
+            fmt::println(stderr, "{}", error.value());
+            exit_code = 1;
+        }
+    }
+
+    const double elapsed = std::chrono::duration<double>{ clock::now() - start }.count();
+    fmt::println(
+        "{} files, {} chunks, {:.1f}s of audio in {:.2f}s ({:.1f}x real time)",
+        files.size(),
+        chunks.size(),
+        total_seconds,
+        elapsed,
+        total_seconds / elapsed
+    );
+    return exit_code;
+}
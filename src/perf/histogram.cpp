@@ -0,0 +1,113 @@
+//
+// Created by usatiynyan.
+//
+
+#include "perf/histogram.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace perf {
+
+void Histogram::record(std::chrono::nanoseconds duration) {
+    const auto value = static_cast<std::uint64_t>(std::max(duration.count(), std::chrono::nanoseconds::rep{ 0 }));
+    buckets_[bucket_of(value)].fetch_add(1, std::memory_order::relaxed);
+    std::uint64_t max = max_.load(std::memory_order::relaxed);
+    while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order::relaxed)) {}
+}
+
+void Histogram::reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order::relaxed);
+    }
+    max_.store(0, std::memory_order::relaxed);
+}
+
+Histogram::Summary Histogram::summary() const {
+    std::array<std::uint64_t, bucket_count> counts{};
+    std::uint64_t count = 0;
+    for (std::size_t bucket = 0; bucket < bucket_count; ++bucket) {
+        counts[bucket] = buckets_[bucket].load(std::memory_order::relaxed);
+        count += counts[bucket];
+    }
+    const std::uint64_t max = max_.load(std::memory_order::relaxed);
+
+    const auto percentile = [&](std::uint64_t per_mille) {
+        const std::uint64_t rank = (count * per_mille + 999) / 1000;
+        std::uint64_t cumulative = 0;
+        for (std::size_t bucket = 0; bucket < bucket_count; ++bucket) {
+            cumulative += counts[bucket];
+            if (cumulative >= rank) {
+                return std::chrono::nanoseconds{ static_cast<std::int64_t>(std::min(bucket_upper_bound(bucket), max)) };
+            }
+        }
+        return std::chrono::nanoseconds{ static_cast<std::int64_t>(max) };
+    };
+
+    return Summary{
+        .count = count,
+        .p50 = count == 0 ? std::chrono::nanoseconds{} : percentile(500),
+        .p99 = count == 0 ? std::chrono::nanoseconds{} : percentile(990),
+        .max = std::chrono::nanoseconds{ static_cast<std::int64_t>(max) },
+    };
+}
+
+std::size_t Histogram::bucket_of(std::uint64_t value) {
+    constexpr std::uint64_t sub_bucket_count = 1 << sub_bucket_bits;
+    if (value < sub_bucket_count) { // exact
+        return static_cast<std::size_t>(value);
+    }
+    const auto msb = static_cast<std::size_t>(std::bit_width(value) - 1);
+    const auto shift = msb - sub_bucket_bits;
+    const auto sub_bucket = static_cast<std::size_t>((value >> shift) & (sub_bucket_count - 1));
+    return ((shift + 1) << sub_bucket_bits) + sub_bucket;
+}
+
+std::uint64_t Histogram::bucket_upper_bound(std::size_t bucket) {
+    constexpr std::size_t sub_bucket_count = 1 << sub_bucket_bits;
+    if (bucket < sub_bucket_count) {
+        return bucket;
+    }
+    const std::size_t shift = (bucket >> sub_bucket_bits) - 1;
+    const std::uint64_t sub_bucket = bucket & (sub_bucket_count - 1);
+    const std::uint64_t lower = (std::uint64_t{ sub_bucket_count } | sub_bucket) << shift;
+    return lower + ((std::uint64_t{ 1 } << shift) - 1);
+}
+
+std::string_view stage_name(Stage stage) {
+    switch (stage) {
+    case Stage::INGESTION:
+        return "ingestion";
+    case Stage::DEINTERLEAVE:
+        return "deinterleave";
+    case Stage::DECIMATE:
+        return "decimate";
+    case Stage::FFT:
+        return "fft";
+    case Stage::CONSTANT_Q:
+        return "constant-q";
+    case Stage::SPECTRUM:
+        return "spectrum";
+    case Stage::BANDS:
+        return "bands";
+    case Stage::TBO_UPLOAD:
+        return "tbo upload";
+    case Stage::DRAW:
+        return "draw";
+    default:
+        break;
+    }
+    return "unknown";
+}
+
+Histogram& histogram(Stage stage) {
+    static std::array<Histogram, static_cast<std::size_t>(Stage::ENUM_END)> histograms;
+    return histograms[static_cast<std::size_t>(stage)];
+}
+
+Histogram& capture_latency() {
+    static Histogram histogram;
+    return histogram;
+}
+
+} // namespace perf
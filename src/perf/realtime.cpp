@@ -0,0 +1,62 @@
+//
+// Created by usatiynyan.
+//
+
+#include "perf/realtime.hpp"
+
+#include <atomic>
+
+namespace perf::realtime {
+namespace {
+
+// trivially initialized, so touching it from inside operator new does not allocate
+thread_local std::uint32_t realtime_depth = 0;
+
+std::atomic<bool> checked{ false };
+std::atomic<std::uint64_t> allocations{ 0 };
+std::atomic<std::uint64_t> deallocations{ 0 };
+std::atomic<std::uint64_t> blocking_calls{ 0 };
+
+} // namespace
+
+Section::Section() { ++realtime_depth; }
+Section::~Section() { --realtime_depth; }
+
+bool is_realtime_thread() { return realtime_depth > 0; }
+bool is_checked() { return checked.load(std::memory_order::relaxed); }
+
+Violations violations() {
+    return Violations{
+        .allocations = allocations.load(std::memory_order::relaxed),
+        .deallocations = deallocations.load(std::memory_order::relaxed),
+        .blocking_calls = blocking_calls.load(std::memory_order::relaxed),
+    };
+}
+
+void reset() {
+    allocations.store(0, std::memory_order::relaxed);
+    deallocations.store(0, std::memory_order::relaxed);
+    blocking_calls.store(0, std::memory_order::relaxed);
+}
+
+void mark_checked() { checked.store(true, std::memory_order::relaxed); }
+
+void on_allocation() {
+    if (is_realtime_thread()) {
+        allocations.fetch_add(1, std::memory_order::relaxed);
+    }
+}
+
+void on_deallocation() {
+    if (is_realtime_thread()) {
+        deallocations.fetch_add(1, std::memory_order::relaxed);
+    }
+}
+
+void on_blocking_call() {
+    if (is_realtime_thread()) {
+        blocking_calls.fetch_add(1, std::memory_order::relaxed);
+    }
+}
+
+} // namespace perf::realtime
@@ -0,0 +1,172 @@
+//
+// Created by usatiynyan.
+//
+
+// replaces the global allocator and interposes pthread locks to feed perf::realtime
+// must be linked into an executable directly, a static library would not override anything
+
+#include "perf/realtime.hpp"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#if defined(__linux__)
+#include <dlfcn.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+#include <atomic>
+#endif
+
+namespace {
+
+const bool is_marked = (perf::realtime::mark_checked(), true);
+
+void* allocate(std::size_t size) {
+    perf::realtime::on_allocation();
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* allocate(std::size_t size, std::align_val_t alignment) {
+    perf::realtime::on_allocation();
+    const auto align = static_cast<std::size_t>(alignment);
+    const std::size_t aligned_size = (size + align - 1) / align * align; // aligned_alloc requires a multiple
+#if defined(_WIN32)
+    return _aligned_malloc(aligned_size == 0 ? align : aligned_size, align);
+#else
+    return std::aligned_alloc(align, aligned_size == 0 ? align : aligned_size);
+#endif
+}
+
+void* allocate_or_throw(std::size_t size) {
+    if (void* ptr = allocate(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void* allocate_or_throw(std::size_t size, std::align_val_t alignment) {
+    if (void* ptr = allocate(size, alignment)) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void deallocate(void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    perf::realtime::on_deallocation();
+    std::free(ptr);
+}
+
+void deallocate(void* ptr, std::align_val_t) {
+    if (ptr == nullptr) {
+        return;
+    }
+    perf::realtime::on_deallocation();
+#if defined(_WIN32)
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return allocate_or_throw(size); }
+void* operator new[](std::size_t size) { return allocate_or_throw(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocate_or_throw(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocate_or_throw(size, alignment); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate(size, alignment);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, std::align_val_t alignment) noexcept { deallocate(ptr, alignment); }
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept { deallocate(ptr, alignment); }
+void operator delete(void* ptr, std::size_t, std::align_val_t alignment) noexcept { deallocate(ptr, alignment); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t alignment) noexcept { deallocate(ptr, alignment); }
+void operator delete(void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    deallocate(ptr, alignment);
+}
+void operator delete[](void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    deallocate(ptr, alignment);
+}
+
+#if defined(__linux__)
+
+namespace {
+
+// resolved lazily without function-local statics, their guards may lock a mutex themselves
+template <typename F>
+F* next_symbol(std::atomic<F*>& symbol, const char* name) {
+    F* resolved = symbol.load(std::memory_order::relaxed);
+    if (resolved == nullptr) {
+        resolved = reinterpret_cast<F*>(dlsym(RTLD_NEXT, name));
+        symbol.store(resolved, std::memory_order::relaxed);
+    }
+    return resolved;
+}
+
+using mutex_lock_type = int(pthread_mutex_t*);
+using rwlock_lock_type = int(pthread_rwlock_t*);
+using cond_wait_type = int(pthread_cond_t*, pthread_mutex_t*);
+using cond_timedwait_type = int(pthread_cond_t*, pthread_mutex_t*, const timespec*);
+using sem_wait_type = int(sem_t*);
+
+std::atomic<mutex_lock_type*> next_mutex_lock{ nullptr };
+std::atomic<rwlock_lock_type*> next_rwlock_rdlock{ nullptr };
+std::atomic<rwlock_lock_type*> next_rwlock_wrlock{ nullptr };
+std::atomic<cond_wait_type*> next_cond_wait{ nullptr };
+std::atomic<cond_timedwait_type*> next_cond_timedwait{ nullptr };
+std::atomic<sem_wait_type*> next_sem_wait{ nullptr };
+
+} // namespace
+
+extern "C" {
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept {
+    perf::realtime::on_blocking_call();
+    return next_symbol(next_mutex_lock, "pthread_mutex_lock")(mutex);
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t* rwlock) noexcept {
+    perf::realtime::on_blocking_call();
+    return next_symbol(next_rwlock_rdlock, "pthread_rwlock_rdlock")(rwlock);
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t* rwlock) noexcept {
+    perf::realtime::on_blocking_call();
+    return next_symbol(next_rwlock_wrlock, "pthread_rwlock_wrlock")(rwlock);
+}
+
+int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex) {
+    perf::realtime::on_blocking_call();
+    return next_symbol(next_cond_wait, "pthread_cond_wait")(cond, mutex);
+}
+
+int pthread_cond_timedwait(pthread_cond_t* cond, pthread_mutex_t* mutex, const timespec* abstime) {
+    perf::realtime::on_blocking_call();
+    return next_symbol(next_cond_timedwait, "pthread_cond_timedwait")(cond, mutex, abstime);
+}
+
+int sem_wait(sem_t* sem) {
+    perf::realtime::on_blocking_call();
+    return next_symbol(next_sem_wait, "sem_wait")(sem);
+}
+
+} // extern "C"
+
+#endif
@@ -0,0 +1,238 @@
+//
+// Created by usatiynyan.
+//
+
+#include "perf/trace.hpp"
+
+#include <sl/meta/assert.hpp>
+#include <spdlog/spdlog.h>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+namespace perf::trace {
+namespace {
+
+using clock = std::chrono::steady_clock;
+
+struct Event {
+    const char* name;
+    std::uint64_t timestamp; // ns since the trace was enabled
+    char phase; // 'B' or 'E'
+};
+
+// written only by the thread that owns it, events below count are immutable and can be read by dump
+// a released buffer goes to the next thread of the same name, which continues it, so reopened devices
+// keep one track each instead of using up the buffers
+// 64 is the cache line size, so neighbouring threads do not share their counters
+struct alignas(64) ThreadBuffer {
+    std::unique_ptr<Event[]> events; // allocated by enable
+    std::atomic<std::size_t> count{ 0 };
+    std::atomic<std::uint64_t> dropped{ 0 };
+    std::atomic<const char*> name{ nullptr };
+    std::atomic<bool> is_owned{ true }; // claimed buffers start owned, so no other thread can take them in between
+    std::atomic<std::uint64_t> lease{ 0 }; // bumped by every claim, an owner with an older lease lost the buffer
+};
+
+struct Tracer {
+    std::filesystem::path output;
+    std::size_t capacity;
+    std::size_t max_threads;
+    std::unique_ptr<ThreadBuffer[]> buffers;
+    std::atomic<std::size_t> next_buffer{ 0 };
+    std::atomic<std::uint64_t> dropped_threads{ 0 };
+    clock::time_point origin;
+};
+
+std::atomic<Tracer*> global_tracer{ nullptr };
+
+bool is_same_name(const char* a, const char* b) {
+    return a == b || (a != nullptr && b != nullptr && std::strcmp(a, b) == 0);
+}
+
+// a buffer given up by a finished thread of the same name, or a new one, null if max_threads are in use
+// only atomics, so it can run on a real-time thread
+ThreadBuffer* claim_buffer(Tracer& tracer, const char* name) {
+    const std::size_t claimed = std::min(tracer.next_buffer.load(std::memory_order::acquire), tracer.max_threads);
+    for (std::size_t index = 0; index < claimed; ++index) {
+        ThreadBuffer& buffer = tracer.buffers[index];
+        bool is_owned = false;
+        if (is_same_name(buffer.name.load(std::memory_order::relaxed), name)
+            && buffer.is_owned.compare_exchange_strong(is_owned, true, std::memory_order::acquire)) {
+            buffer.lease.fetch_add(1, std::memory_order::relaxed);
+            return &buffer;
+        }
+    }
+
+    const std::size_t index = tracer.next_buffer.fetch_add(1, std::memory_order::acq_rel);
+    if (index >= tracer.max_threads) {
+        tracer.dropped_threads.fetch_add(1, std::memory_order::relaxed);
+        return nullptr;
+    }
+    ThreadBuffer& buffer = tracer.buffers[index];
+    buffer.name.store(name, std::memory_order::relaxed);
+    return &buffer;
+}
+
+// name is used only if this is the first call of the thread or it lost its buffer to release_thread
+// the claim is trivially destructible, so a thread that traces registers no exit hook
+ThreadBuffer* thread_buffer(Tracer& tracer, const char* name = nullptr) {
+    struct Claim {
+        ThreadBuffer* buffer = nullptr;
+        std::uint64_t lease = 0;
+        bool is_claimed = false;
+    };
+    thread_local Claim claim;
+    const bool is_lost =
+        claim.buffer != nullptr && claim.buffer->lease.load(std::memory_order::relaxed) != claim.lease;
+    if (!claim.is_claimed || is_lost) {
+        if (is_lost && name == nullptr) { // a backend that reuses its threads, the thread keeps its name
+            name = claim.buffer->name.load(std::memory_order::relaxed);
+        }
+        claim.is_claimed = true;
+        claim.buffer = claim_buffer(tracer, name);
+        if (claim.buffer != nullptr) {
+            claim.lease = claim.buffer->lease.load(std::memory_order::relaxed);
+        }
+    }
+    return claim.buffer;
+}
+
+void record(const char* name, char phase) {
+    Tracer* tracer = global_tracer.load(std::memory_order::acquire);
+    if (tracer == nullptr) {
+        return;
+    }
+    ThreadBuffer* buffer = thread_buffer(*tracer);
+    if (buffer == nullptr) {
+        return;
+    }
+    const std::size_t count = buffer->count.load(std::memory_order::relaxed);
+    if (count == tracer->capacity) {
+        buffer->dropped.fetch_add(1, std::memory_order::relaxed);
+        return;
+    }
+    const auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - tracer->origin);
+    buffer->events[count] = Event{ name, static_cast<std::uint64_t>(timestamp.count()), phase };
+    buffer->count.store(count + 1, std::memory_order::release);
+}
+
+} // namespace
+
+void enable(std::filesystem::path output, const Options& options) {
+    ASSERT(global_tracer.load(std::memory_order::relaxed) == nullptr);
+    // never freed, threads may still be recording while the process exits
+    // every event buffer is allocated here, so no thread allocates on its first event, not even a real-time one
+    // they are left uninitialized, so untouched events cost address space but no memory
+    auto* tracer = new Tracer{
+        .output = std::move(output),
+        .capacity = options.events_per_thread,
+        .max_threads = options.max_threads,
+        .buffers = std::make_unique<ThreadBuffer[]>(options.max_threads),
+        .origin = clock::now(),
+    };
+    for (std::size_t index = 0; index < tracer->max_threads; ++index) {
+        tracer->buffers[index].events = std::make_unique_for_overwrite<Event[]>(tracer->capacity);
+    }
+    global_tracer.store(tracer, std::memory_order::release);
+    spdlog::info("tracing into {}", tracer->output.string());
+}
+
+void enable_from_environment() {
+    if (const char* output = std::getenv("SMV_TRACE"); output != nullptr && *output != '\0') {
+        enable(output);
+    }
+}
+
+bool is_enabled() { return global_tracer.load(std::memory_order::relaxed) != nullptr; }
+
+void name_thread(const char* name) {
+    Tracer* tracer = global_tracer.load(std::memory_order::acquire);
+    if (tracer == nullptr) {
+        return;
+    }
+    if (ThreadBuffer* buffer = thread_buffer(*tracer, name)) { // names a buffer claimed by an earlier event
+        const char* expected = nullptr;
+        buffer->name.compare_exchange_strong(expected, name, std::memory_order::relaxed);
+    }
+}
+
+void release_thread(const char* name) {
+    Tracer* tracer = global_tracer.load(std::memory_order::acquire);
+    if (tracer == nullptr) {
+        return;
+    }
+    const std::size_t claimed = std::min(tracer->next_buffer.load(std::memory_order::acquire), tracer->max_threads);
+    for (std::size_t index = 0; index < claimed; ++index) {
+        ThreadBuffer& buffer = tracer->buffers[index];
+        if (is_same_name(buffer.name.load(std::memory_order::relaxed), name)) {
+            buffer.is_owned.store(false, std::memory_order::release);
+        }
+    }
+}
+
+void begin(const char* name) { record(name, 'B'); }
+void end(const char* name) { record(name, 'E'); }
+
+void dump() {
+    Tracer* tracer = global_tracer.load(std::memory_order::acquire);
+    if (tracer == nullptr) {
+        return;
+    }
+
+    fmt::memory_buffer json;
+    fmt::format_to(std::back_inserter(json), R"({{"displayTimeUnit":"ns","traceEvents":[)");
+    bool is_first = true;
+    const auto separator = [&] { return std::exchange(is_first, false) ? "" : ","; };
+
+    std::uint64_t dropped = 0;
+    const std::size_t buffers = std::min(tracer->next_buffer.load(std::memory_order::acquire), tracer->max_threads);
+    for (std::size_t tid = 0; tid < buffers; ++tid) {
+        const ThreadBuffer& buffer = tracer->buffers[tid];
+        dropped += buffer.dropped.load(std::memory_order::relaxed);
+        if (const char* name = buffer.name.load(std::memory_order::relaxed)) {
+            fmt::format_to(
+                std::back_inserter(json),
+                R"({}{{"ph":"M","name":"thread_name","pid":1,"tid":{},"args":{{"name":"{}"}}}})",
+                separator(),
+                tid,
+                name
+            );
+        }
+        const std::size_t count = buffer.count.load(std::memory_order::acquire);
+        for (std::size_t index = 0; index < count; ++index) {
+            const Event& event = buffer.events[index];
+            fmt::format_to(
+                std::back_inserter(json),
+                R"({}{{"ph":"{}","name":"{}","pid":1,"tid":{},"ts":{:.3f}}})",
+                separator(),
+                event.phase,
+                event.name,
+                tid,
+                static_cast<double>(event.timestamp) / 1000.0
+            );
+        }
+    }
+    fmt::format_to(std::back_inserter(json), "]}}\n");
+
+    std::ofstream stream{ tracer->output, std::ios::binary | std::ios::trunc };
+    stream.write(json.data(), static_cast<std::streamsize>(json.size()));
+    spdlog::info(
+        "trace written into {}, dropped {} events and {} threads",
+        tracer->output.string(),
+        dropped,
+        tracer->dropped_threads.load(std::memory_order::relaxed)
+    );
+}
+
+} // namespace perf::trace
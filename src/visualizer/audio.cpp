@@ -5,14 +5,18 @@
 #include "visualizer/audio.hpp"
 #include "visualizer/render.hpp"
 
+#include "audio/deinterleave.hpp"
+#include "perf/histogram.hpp"
+#include "perf/realtime.hpp"
+#include "perf/trace.hpp"
+
 #include <miniaudio/miniaudio.hpp>
 
-#include <sl/calc/fourier.hpp>
+#include <fmt/chrono.h>
+
 #include <sl/meta/lifetime/defer.hpp>
 
-#include <range/v3/view/stride.hpp>
-#include <range/v3/view/take.hpp>
-#include <range/v3/view/transform.hpp>
+#include <range/v3/view/enumerate.hpp>
 
 #include <imgui.h>
 #include <implot.h>
@@ -20,44 +24,145 @@
 #include <sl/meta/match/match_map.hpp>
 
 namespace visualizer {
+namespace {
+
+std::unique_ptr<audio::Analyzer> make_analyzer(
+    audio::FftPlanCache& fft_plans,
+    const audio::DataConfig& config,
+    SpectrumMode spectrum_mode,
+    audio::WindowFunction window_function
+) {
+    std::shared_ptr<const audio::ConstantQ> constant_q;
+    std::unique_ptr<audio::MultiResolution> multi_resolution;
+    if (spectrum_mode == SpectrumMode::MULTI_RESOLUTION) {
+        const audio::MultiResolutionConfig multi_resolution_config{ .window_function = window_function };
+        multi_resolution = std::make_unique<audio::MultiResolution>(config, multi_resolution_config, fft_plans);
+    } else if (spectrum_mode != SpectrumMode::FFT) {
+        audio::ConstantQConfig constant_q_config{};
+        if (spectrum_mode == SpectrumMode::VARIABLE_Q) {
+            constant_q_config.gamma = audio::ConstantQConfig::erb_gamma(constant_q_config.bins_per_octave);
+        }
+        constant_q =
+            std::make_shared<const audio::ConstantQ>(constant_q_config, config.frame_count, config.sample_rate);
+    }
+    return std::make_unique<audio::Analyzer>(
+        config,
+        fft_plans.real(config.frame_count),
+        /* parallel_rows = */ true,
+        std::move(constant_q),
+        std::move(multi_resolution),
+        window_function
+    );
+}
+
+AudioState::Intermediate make_intermediate(
+    const audio::DataConfig& config,
+    const audio::Analyzer& analyzer,
+    const audio::BandMap& band_map
+) {
+    return AudioState::Intermediate{
+        .spectrum{ config, analyzer.bins() },
+        .bands = std::vector<float>(audio::planar_rows(config.capture_channels) * band_map.bands()),
+        .half_freq_domain = std::vector<std::complex<float>>(config.frame_count / 2),
+        .abs_half_freq_domain = std::vector<float>(config.frame_count / 2),
+        .log_abs_half_freq_domain = std::vector<float>(config.frame_count / 2),
+    };
+}
+
+void publish_spectrum(
+    RenderState& render_state,
+    std::size_t rows,
+    std::size_t bands,
+    const std::vector<float>& normalized,
+    float sound_level,
+    std::optional<audio::capture_clock::time_point> captured_at = std::nullopt // none for a replay
+) {
+    if (render_state.nfdo_row.get().value_or(0u) >= rows) { // source has fewer channels now
+        render_state.nfdo_row.set(0u);
+    }
+    render_state.nfdo_bins.set_if_ne(static_cast<GLuint>(bands));
+    render_state.normalized_freq_proc_output.set(normalized);
+    if (captured_at.has_value()) {
+        render_state.captured_at.set(*captured_at);
+    }
+    render_state.sound_level.set_if_ne(sound_level);
+}
+
+// values per row that go to RenderState and into recordings
+std::size_t published_bins(const AudioState& audio_state) {
+    return audio_state.analyzer->is_constant_q() ? audio_state.analyzer->bins() : audio_state.band_map.bands();
+}
+
+} // namespace
 
 sl::exec::async<entt::entity> create_audio_entity(
-    sl::game::engine_context& e_ctx,
     sl::ecs::layer& layer,
     const audio::DataConfig& config,
     entt::entity render_entity
 ) {
     const auto entity = layer.registry.create();
 
+    audio::FftPlanCache fft_plans;
+    auto analyzer = make_analyzer(fft_plans, config, SpectrumMode::FFT);
+    audio::BandMap band_map{ audio::BandConfig{}, config.frame_count / 2, config.sample_rate };
+    auto intermediate = make_intermediate(config, *analyzer, band_map);
+
     const auto& audio_state = layer.registry.emplace<AudioState>(
         entity,
         AudioState{
+            .config = config,
             .context{},
-            .callback = std::make_unique<audio::DataCallback>(config, *e_ctx.sync_exec),
-            .intermediate{},
+            .fft_plans = std::move(fft_plans),
+            .callback = std::make_unique<audio::DataCallback>(config),
+            .analyzer = std::move(analyzer),
+            .worker{},
+            .band_map = std::move(band_map),
+            .intermediate = std::move(intermediate),
+            .recording{},
+            .replay{},
             .device{
                 .handle = sl::meta::err(MA_SUCCESS),
                 .running = sl::meta::err(MA_SUCCESS),
+                .synthetic{},
+                .file{},
             },
             .device_controls{
                 .type{},
                 .index{},
+                .file{},
+                .file_input{},
+            },
+            .analysis_controls{
+                .use_worker{},
+                .frame_count{ config.frame_count },
+                .frame_window{ config.frame_window },
+                .max_frame_count{ config.max_frame_count },
+                .spectrum_mode{},
+                .window_function{},
+                .latency_policy{ audio::LatencyPolicy{} },
+                .band_config{},
+            },
+            .recording_controls{
+                .record{},
             },
         }
     );
     spdlog::info("selected backend={}", audio_state.context.backend_name());
     layer.registry.emplace<sl::game::update>(
         entity,
-        [&config, render_entity](sl::ecs::layer& layer, entt::entity entity, sl::game::time_point time_point) {
+        [render_entity](sl::ecs::layer& layer, entt::entity entity, sl::game::time_point time_point) {
             auto& audio_state = layer.registry.get<AudioState>(entity);
-            audio_update_process(config, layer, render_entity, audio_state, time_point);
-            audio_update_device(config, audio_state);
+            audio_update_process(layer, render_entity, audio_state, time_point);
+            audio_update_analysis(audio_state);
+            audio_update_recording(audio_state);
+            audio_update_device(audio_state);
         }
     );
     layer.registry.emplace<sl::game::overlay>(
         entity,
-        [&config](sl::ecs::layer& layer, sl::gfx::imgui_frame& imgui_frame, entt::entity entity) {
-            audio_overlay(config, layer, imgui_frame, entity);
+        [render_entity](sl::ecs::layer& layer, sl::gfx::imgui_frame& imgui_frame, entt::entity entity) {
+            audio_overlay(layer, imgui_frame, entity, render_entity);
+            performance_overlay(imgui_frame);
         }
     );
 
@@ -65,58 +170,31 @@ sl::exec::async<entt::entity> create_audio_entity(
 }
 
 void audio_update_process(
-    const audio::DataConfig& config,
     sl::ecs::layer& layer,
     entt::entity render_entity,
     AudioState& audio_state,
     sl::game::time_point time_point
 ) {
-    namespace r = ranges;
-    namespace rv = r::views;
+    const perf::trace::Scope trace{ "audio_update_process" };
+    auto& intermediate = audio_state.intermediate;
 
-    // FETCH TIME DOMAIN INPUT
-    while (audio_state.callback->try_consume(config, [&](std::span<const float> input) {
-        ASSERT(input.size() == config.frame_size);
-        const auto range = input | rv::stride(config.capture_channels);
-        audio_state.intermediate.time_domain.assign(range.begin(), range.end());
-    })) {}
-
-    if (audio_state.intermediate.time_domain.size() != config.frame_count) {
+    if (audio_state.replay.recording.has_value()) {
+        audio_update_replay(layer, render_entity, audio_state, time_point);
         return;
     }
 
-    {
-        const auto& td = audio_state.intermediate.time_domain;
-        const float rms = std::accumulate(td.begin(), td.end(), 0.0f, [](float acc, std::complex<float> x) {
-            return acc + (std::abs(x));
-        });
-    }
-
-
-    // CALCULATE FFT (TIME DOMAIN -> FREQ DOMAIN)
-    audio_state.intermediate.freq_domain = sl::calc::fft<sl::calc::fourier::direction::time_to_freq>(
-        std::span<const std::complex<float>>{ audio_state.intermediate.time_domain }
-    );
+    audio_state.recording.elapsed += std::chrono::duration_cast<std::chrono::nanoseconds>(time_point.delta_sec());
 
-    audio_state.intermediate.half_freq_domain = audio_state.intermediate.freq_domain
-                                                | rv::take(audio_state.intermediate.freq_domain.size() / 2)
-                                                | r::to<std::vector>();
-
-    audio_state.intermediate.abs_half_freq_domain =
-        audio_state.intermediate.half_freq_domain //
-        | rv::transform([](std::complex<float> x) { return std::abs(x); }) //
-        | r::to<std::vector>();
-
-    audio_state.intermediate.log_abs_half_freq_domain = audio_state.intermediate.abs_half_freq_domain //
-                                                        | rv::transform([](float x) { return std::log(x); }) //
-                                                        | r::to<std::vector>();
+    if (!audio_state.worker) {
+        audio_state.analyzer->update(*audio_state.callback, intermediate.spectrum, intermediate.snapshot_requested);
+        intermediate.snapshot_requested = false;
+    }
 
-    const float N = static_cast<float>(audio_state.intermediate.freq_domain.size());
-    const float normalize_by = std::log(N);
-    audio_state.intermediate.normalized_freq_domain_output =
-        audio_state.intermediate.log_abs_half_freq_domain //
-        | rv::transform([normalize_by](float value) { return value / normalize_by; }) //
-        | r::to<std::vector>();
+    const audio::Spectrum& spectrum = audio_latest_spectrum(audio_state);
+    if (spectrum.generation == intermediate.generation) { // no new hop since the last frame
+        return;
+    }
+    intermediate.generation = spectrum.generation;
 
     // thanks Freya Holmer <3
     constexpr auto exp_decay = [](float a, float b, float decay, float dt) -> float {
@@ -125,55 +203,387 @@ void audio_update_process(
     constexpr float decay = 16;
 
     {
-        const float abs_acc = std::accumulate(
-            audio_state.intermediate.normalized_freq_domain_output.begin(),
-            audio_state.intermediate.normalized_freq_domain_output.end(),
-            0.0f,
-            [](float acc, float x) { return acc + ((x + 1.0f) / 2.0f); }
-        );
-        const float abs_acc_over_N = abs_acc / N;
+        // fft size for the linear spectrum, the same scale for constant-Q bins
+        const float N = static_cast<float>(2 * spectrum.bins);
+        const float abs_acc_over_N = spectrum.level_sums[0] / N;
         const float abs_acc_over_N_clamped = std::clamp(abs_acc_over_N, 0.0f, 1.0f);
-        audio_state.intermediate.sound_level = exp_decay( //
-            audio_state.intermediate.sound_level,
+        intermediate.sound_level = exp_decay( //
+            intermediate.sound_level,
             abs_acc_over_N_clamped,
             decay,
             time_point.delta_sec().count()
         );
     }
 
+    // BANDS: once per spectrum here, so the shader indexes bands directly instead of warping bins per pixel
+    // constant-Q bins are log spaced already and go as they are
+    const bool is_banded = !audio_state.analyzer->is_constant_q();
+    if (is_banded) {
+        const perf::ScopedTimer timer{ perf::Stage::BANDS };
+        const std::size_t bands = audio_state.band_map.bands();
+        for (std::size_t row = 0; row < spectrum.rows; ++row) {
+            audio_state.band_map.apply(spectrum.row(row), std::span{ intermediate.bands }.subspan(row * bands, bands));
+        }
+    }
+    const std::vector<float>& published = is_banded ? intermediate.bands : spectrum.normalized;
+
     if (auto* render_state = layer.registry.try_get<RenderState>(render_entity)) {
-        render_state->normalized_freq_proc_output.set(audio_state.intermediate.normalized_freq_domain_output);
-        render_state->sound_level.set_if_ne(audio_state.intermediate.sound_level);
+        publish_spectrum(
+            *render_state,
+            spectrum.rows,
+            published_bins(audio_state),
+            published,
+            intermediate.sound_level,
+            spectrum.captured_at
+        );
+    }
+    if (auto& recorder = audio_state.recording.recorder) {
+        recorder->write(audio_state.recording.elapsed, intermediate.sound_level, published);
+    }
+}
+
+void audio_update_replay(
+    sl::ecs::layer& layer,
+    entt::entity render_entity,
+    AudioState& audio_state,
+    sl::game::time_point time_point
+) {
+    auto& replay = audio_state.replay;
+    auto& recording = replay.recording.value();
+    replay.elapsed += std::chrono::duration_cast<std::chrono::nanoseconds>(time_point.delta_sec());
+
+    // catch up with the clock, frames that are already late are decoded but only the latest one is rendered
+    bool has_new_frame = false;
+    sl::meta::result<bool, std::string> has_next = true;
+    while (has_next && replay.pending.timestamp <= replay.elapsed) {
+        std::swap(replay.current, replay.pending);
+        has_new_frame = true;
+        has_next = recording.next(replay.pending);
+        if (has_next && !*has_next) { // loop
+            has_next = recording.seek(0).and_then([&](sl::meta::unit) { return recording.next(replay.pending); });
+            replay.elapsed = replay.pending.timestamp;
+            break;
+        }
+    }
+
+    if (has_new_frame) {
+        audio_state.intermediate.sound_level = replay.current.sound_level;
+        if (auto* render_state = layer.registry.try_get<RenderState>(render_entity)) {
+            const auto& header = recording.header();
+            publish_spectrum(
+                *render_state, header.rows, header.bins, replay.current.normalized, replay.current.sound_level
+            );
+        }
+    }
+
+    // a corrupt frame stops the replay, the frames before it have been rendered
+    if (!has_next) {
+        spdlog::error("[replay] {}", has_next.error());
+        replay.recording.reset();
+    }
+}
+
+const audio::Spectrum& audio_latest_spectrum(AudioState& audio_state) {
+    return audio_state.worker ? audio_state.worker->latest() : audio_state.intermediate.spectrum;
+}
+
+void audio_update_debug_intermediates(const audio::Spectrum& spectrum, AudioState::Intermediate& intermediate) {
+    if (intermediate.debug_generation == spectrum.snapshot_generation) {
+        return;
+    }
+    intermediate.debug_generation = spectrum.snapshot_generation;
+
+    std::copy_n(
+        spectrum.freq_domain.begin(), intermediate.half_freq_domain.size(), intermediate.half_freq_domain.begin()
+    );
+    std::transform(
+        intermediate.half_freq_domain.begin(),
+        intermediate.half_freq_domain.end(),
+        intermediate.abs_half_freq_domain.begin(),
+        [](std::complex<float> x) { return std::abs(x); }
+    );
+    std::transform(
+        intermediate.abs_half_freq_domain.begin(),
+        intermediate.abs_half_freq_domain.end(),
+        intermediate.log_abs_half_freq_domain.begin(),
+        [](float x) { return std::log(x); }
+    );
+}
+
+void audio_update_analysis(AudioState& audio_state) {
+    audio_state.analysis_controls.use_worker.release().map([&](bool use_worker) {
+        if (use_worker == static_cast<bool>(audio_state.worker)) {
+            return;
+        }
+        if (use_worker) {
+            audio_state.worker = std::make_unique<audio::AnalysisWorker>(
+                audio_state.config, *audio_state.callback, *audio_state.analyzer
+            );
+        } else {
+            audio_state.worker.reset(); // joins the thread, analyzer is ours again
+        }
+    });
+    audio_state.analysis_controls.latency_policy.release().map([&](const audio::LatencyPolicy& latency_policy) {
+        audio_state.analyzer->set_latency_policy(latency_policy);
+    });
+    audio_state.analysis_controls.band_config.release().map([&](const audio::BandConfig& band_config) {
+        if (band_config == audio_state.band_map.config()) {
+            return;
+        }
+        if (audio_state.recording.recorder) { // bands of a recording are fixed
+            audio_state.recording.recorder.reset();
+            spdlog::info("recording stopped, bands have been reconfigured");
+        }
+        const auto& config = audio_state.config;
+        audio_state.band_map = audio::BandMap{ band_config, config.frame_count / 2, config.sample_rate };
+        audio_state.intermediate.bands.resize(audio::planar_rows(config.capture_channels) * band_config.bands);
+        audio_state.intermediate.generation = 0; // republish the current spectrum in the new bands
+    });
+
+    auto& controls = audio_state.analysis_controls;
+    const sl::meta::maybe<std::size_t> maybe_frame_count = controls.frame_count.release();
+    const sl::meta::maybe<std::size_t> maybe_frame_window = controls.frame_window.release();
+    const sl::meta::maybe<std::size_t> maybe_max_frame_count = controls.max_frame_count.release();
+    // only ever set on change
+    const bool is_spectrum_mode_changed = controls.spectrum_mode.release().has_value();
+    const bool is_window_changed = controls.window_function.release().has_value();
+    const bool is_mode_changed = is_spectrum_mode_changed || is_window_changed;
+    if (!maybe_frame_count.has_value() && !maybe_frame_window.has_value() && !maybe_max_frame_count.has_value()
+        && !is_mode_changed) {
+        return;
+    }
+
+    const auto& config = audio_state.config;
+    const std::size_t frame_count = maybe_frame_count.value_or(config.frame_count);
+    // hop can not be longer than the window, and at least one window has to fit into the buffer
+    const audio::DataConfig new_config{
+        config.capture_channels,
+        config.sample_rate,
+        frame_count,
+        std::max(maybe_max_frame_count.value_or(config.max_frame_count), frame_count),
+        std::min(maybe_frame_window.value_or(config.frame_window), frame_count),
+        config.format,
+    };
+    if (new_config == config && !is_mode_changed) {
+        return;
+    }
+    spdlog::info(
+        "analysis: window {} frames, hop {} frames, buffer {} frames",
+        new_config.frame_count,
+        new_config.frame_window,
+        new_config.max_frame_count
+    );
+    audio_reconfigure(audio_state, new_config);
+
+    // reopen the device that audio_reconfigure has closed, audio_update_device picks it up right away
+    audio_state.device_controls.type.get().map([&](SourceType type) {
+        audio_state.device_controls.type.set(type);
+    });
+}
+
+void audio_update_recording(AudioState& audio_state) {
+    audio_state.recording_controls.record.release().map([&](bool record) {
+        auto& recording = audio_state.recording;
+        if (record == static_cast<bool>(recording.recorder)) {
+            return;
+        }
+        if (!record) {
+            recording.recorder->close().map_error([](const std::string& error) {
+                spdlog::error("[recording] {}", error);
+                return error;
+            });
+            recording.recorder.reset();
+            return;
+        }
+
+        const auto now = std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now());
+        const std::filesystem::path path = fmt::format("recording-{:%Y%m%d-%H%M%S}.smvr", now);
+        const std::size_t rows = audio::planar_rows(audio_state.config.capture_channels);
+        auto maybe_recorder = audio::SpectrumRecorder::create(path, rows, published_bins(audio_state))
+                                  .map_error([](const std::string& error) {
+                                      spdlog::error("[recording] {}", error);
+                                      return error;
+                                  });
+        if (!maybe_recorder) {
+            return;
+        }
+        spdlog::info("recording into {}", path.string());
+        recording.recorder = std::move(*maybe_recorder);
+        recording.elapsed = {};
+    });
+}
+
+void audio_reconfigure(AudioState& audio_state, const audio::DataConfig& config) {
+    // device and worker hold on to the callback and the analyzer, so they go first
+    audio_close_device(audio_state);
+    if (audio_state.recording.recorder) { // rows and bands of a recording are fixed
+        audio_state.recording.recorder.reset();
+        spdlog::info("recording stopped, analysis has been reconfigured");
+    }
+    const bool had_worker = static_cast<bool>(audio_state.worker);
+    audio_state.worker.reset();
+
+    // ring, analyzer and spectra are sized by the whole config, so they are rebuilt once per change instead of pooled,
+    // fft plans are the costly part and come from fft_plans, the texture buffer only grows
+    audio_state.config = config;
+    audio_state.callback = std::make_unique<audio::DataCallback>(config);
+    audio_state.analyzer = make_analyzer(
+        audio_state.fft_plans,
+        config,
+        audio_state.analysis_controls.spectrum_mode.get().value_or(SpectrumMode::FFT),
+        audio_state.analysis_controls.window_function.get().value_or(audio::WindowFunction::HANN)
+    );
+    audio_state.analysis_controls.latency_policy.get().map([&](const audio::LatencyPolicy& latency_policy) {
+        audio_state.analyzer->set_latency_policy(latency_policy);
+    });
+    audio_state.band_map = audio::BandMap{
+        audio_state.analysis_controls.band_config.get().value_or(audio::BandConfig{}),
+        config.frame_count / 2,
+        config.sample_rate,
+    };
+    audio_state.intermediate = make_intermediate(config, *audio_state.analyzer, audio_state.band_map);
+
+    if (had_worker) {
+        audio_state.worker =
+            std::make_unique<audio::AnalysisWorker>(config, *audio_state.callback, *audio_state.analyzer);
+    }
+}
+
+void audio_close_device(AudioState& audio_state) {
+    audio_state.device.running = sl::meta::err(MA_SUCCESS);
+    audio_state.device.handle = sl::meta::err(MA_SUCCESS);
+    perf::trace::release_thread("audio device"); // its thread is joined by the uninit above
+    audio_state.device.synthetic.reset();
+    if (audio_state.device.file) {
+        audio_state.device.file_position = audio_state.device.file->position();
+    }
+    audio_state.device.file.reset();
+    audio_state.replay.recording.reset();
+}
+
+void audio_adapt_to_native_format(AudioState& audio_state, const audio::NativeFormat& native_format) {
+    const audio::DataConfig native_config = audio_state.config.with_device_format(
+        native_format.format, native_format.channels, native_format.sample_rate
+    );
+    if (native_config == audio_state.config) {
+        return;
     }
+    spdlog::info(
+        "native format: {}, {} channels, {} Hz",
+        ma_get_format_name(native_format.format),
+        native_format.channels,
+        native_format.sample_rate
+    );
+    audio_reconfigure(audio_state, native_config);
 }
 
-void audio_update_device(const audio::DataConfig& config, AudioState& audio_state) {
-    const sl::meta::maybe<ma_device_type> maybe_new_type = audio_state.device_controls.type.release();
-    const sl::meta::maybe<std::size_t> maybe_new_index = audio_state.device_controls.index.release();
-    if (!maybe_new_type.has_value() && !maybe_new_index.has_value()) { // no updates
+void audio_update_device(AudioState& audio_state) {
+    const perf::trace::Scope trace{ "audio_update_device" };
+    auto& device_controls = audio_state.device_controls;
+    const sl::meta::maybe<SourceType> maybe_new_type = device_controls.type.release();
+    const sl::meta::maybe<std::size_t> maybe_new_index = device_controls.index.release();
+    const sl::meta::maybe<std::filesystem::path> maybe_new_file = device_controls.file.release();
+    if (!maybe_new_type.has_value() && !maybe_new_index.has_value() && !maybe_new_file.has_value()) { // no updates
         return;
     }
 
-    const auto new_type = maybe_new_type.or_else([&] { return audio_state.device_controls.type.get(); });
-    const auto new_index = maybe_new_index.or_else([&] { return audio_state.device_controls.index.get(); });
-    if (!new_type.has_value() || !new_index.has_value()) { // not enough data
+    const auto new_type = maybe_new_type.or_else([&] { return device_controls.type.get(); });
+    if (!new_type.has_value()) { // not enough data
         return;
     }
 
+    switch (new_type.value()) {
+    case SourceType::SYNTHETIC:
+        audio_close_device(audio_state);
+        audio_state.device.synthetic = std::make_unique<audio::SyntheticDevice>(
+            audio_state.config, audio::SyntheticConfig{}, *audio_state.callback
+        );
+        return;
+    case SourceType::REPLAY: {
+        const auto new_file = maybe_new_file.or_else([&] { return device_controls.file.get(); });
+        if (!new_file.has_value()) { // not enough data
+            return;
+        }
+        audio_close_device(audio_state);
+        auto maybe_recording =
+            audio::SpectrumRecording::open(new_file.value()).map_error([](const std::string& error) {
+                spdlog::error("[replay] {}", error);
+                return error;
+            });
+        if (!maybe_recording) {
+            return;
+        }
+        auto& replay = audio_state.replay;
+        replay.recording.emplace(std::move(*maybe_recording));
+        auto has_first = replay.recording->next(replay.pending);
+        if (!has_first) {
+            spdlog::error("[replay] {}", has_first.error());
+            replay.recording.reset();
+            return;
+        }
+        replay.elapsed = replay.pending.timestamp;
+        return;
+    }
+    case SourceType::FILE: {
+        const auto new_file = maybe_new_file.or_else([&] { return device_controls.file.get(); });
+        if (!new_file.has_value()) { // not enough data
+            return;
+        }
+        audio_close_device(audio_state);
+        auto maybe_source = audio::FileSource::open(new_file.value()).map_error([](const std::string& error) {
+            spdlog::error("[file] {}", error);
+            return error;
+        });
+        if (!maybe_source) {
+            return;
+        }
+        std::unique_ptr<audio::FileSource> source = std::move(*maybe_source);
+        // a reopen after reconfiguration or a source switch continues where it was, a newly opened file starts over
+        if (!maybe_new_file.has_value() && !source->seek(audio_state.device.file_position)) {
+            source->seek(0);
+        }
+        audio_adapt_to_native_format(audio_state, source->native_format());
+        audio_state.device.file =
+            std::make_unique<audio::FileDevice>(audio_state.config, std::move(source), *audio_state.callback);
+        return;
+    }
+    default:
+        break;
+    }
+
+    const auto new_index = maybe_new_index.or_else([&] { return device_controls.index.get(); });
+    if (!new_index.has_value()) { // not enough data
+        return;
+    }
+
+    // stop running device
+    audio_close_device(audio_state);
+
+    // open the device in its own format, samples are converted in the analysis stage instead of the real-time thread
+    audio_adapt_to_native_format(
+        audio_state,
+        audio_state.context.capture_native_format(
+            new_index.value(),
+            audio::NativeFormat{
+                .format = audio_state.config.format,
+                .channels = audio_state.config.capture_channels,
+                .sample_rate = audio_state.config.sample_rate,
+            }
+        )
+    );
+
+    const auto& config = audio_state.config;
     const audio::DeviceConfig device_config{
         .index = new_index.value(),
         .channels = config.capture_channels,
     };
 
-    // stop running device
-    audio_state.device.running = sl::meta::err(MA_SUCCESS);
-
     switch (new_type.value()) {
-    case ma_device_type_capture:
+    case SourceType::CAPTURE:
         audio_state.device.handle =
             audio_state.context.create_capture_device(config, device_config, audio_state.callback);
         break;
-    case ma_device_type_loopback:
+    case SourceType::LOOPBACK:
         audio_state.device.handle =
             audio_state.context.create_loopback_device(config, device_config, audio_state.callback);
         break;
@@ -190,32 +600,38 @@ void audio_update_device(const audio::DataConfig& config, AudioState& audio_stat
 }
 
 void audio_overlay(
-    const audio::DataConfig& config,
     sl::ecs::layer& layer,
     sl::gfx::imgui_frame& imgui_frame,
-    entt::entity audio_entity
+    entt::entity audio_entity,
+    entt::entity render_entity
 ) {
-    constexpr auto device_type_to_name = [](ma_device_type device_type) -> std::string_view {
+    constexpr auto device_type_to_name = [](SourceType device_type) -> std::string_view {
         switch (device_type) {
-        case ma_device_type_playback:
-            return "playback";
-        case ma_device_type_capture:
+        case SourceType::CAPTURE:
             return "capture";
-        case ma_device_type_duplex:
-            return "duplex";
-        case ma_device_type_loopback:
+        case SourceType::LOOPBACK:
             return "loopback";
+        case SourceType::SYNTHETIC:
+            return "synthetic";
+        case SourceType::FILE:
+            return "file";
+        case SourceType::REPLAY:
+            return "replay";
         default:
             break;
         }
         return "unknown";
     };
     constexpr std::array device_types{
-        ma_device_type_capture,
-        ma_device_type_loopback,
+        SourceType::CAPTURE,
+        SourceType::LOOPBACK,
+        SourceType::SYNTHETIC,
+        SourceType::FILE,
+        SourceType::REPLAY,
     };
 
     auto& audio_state = layer.registry.get<AudioState>(audio_entity);
+    const auto& config = audio_state.config;
     auto& context = audio_state.context;
     auto& device_controls = audio_state.device_controls;
 
@@ -224,7 +640,7 @@ void audio_overlay(
             /* TODO: ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize */
         )) {
         ImGui::SetWindowPos(ImVec2{ 0.0f, 0.0f });
-        ImGui::SetWindowSize(ImVec2{ 0.0f, 80.0f });
+        ImGui::SetWindowSize(ImVec2{ 0.0f, 0.0f });
 
         const auto preview_device_type =
             device_controls.type.get().map(device_type_to_name).value_or(std::string_view{});
@@ -238,13 +654,15 @@ void audio_overlay(
             ImGui::EndCombo();
         }
 
+        const SourceType current_type = device_controls.type.get().value_or(SourceType::CAPTURE);
+        const bool has_capture_source = current_type == SourceType::CAPTURE || current_type == SourceType::LOOPBACK;
         const auto preview_capture_source = device_controls.index.get()
                                                 .map([&](std::size_t index) {
                                                     const auto& capture_info = context.capture_infos()[index];
                                                     return capture_info.name;
                                                 })
                                                 .value_or("");
-        if (ImGui::BeginCombo("capture source", preview_capture_source)) {
+        if (has_capture_source && ImGui::BeginCombo("capture source", preview_capture_source)) {
             for (const auto& [index, capture_info] : ranges::views::enumerate(context.capture_infos())) {
                 if (ImGui::Selectable(capture_info.name)) {
                     device_controls.index.set_if_ne(index);
@@ -252,6 +670,230 @@ void audio_overlay(
             }
             ImGui::EndCombo();
         }
+
+        if (current_type == SourceType::FILE || current_type == SourceType::REPLAY) {
+            auto& file_input = device_controls.file_input;
+            ImGui::InputText("file", file_input.data(), file_input.size());
+            ImGui::SameLine();
+            if (ImGui::Button("open")) {
+                device_controls.file.set(std::filesystem::path{ file_input.data() });
+            }
+            if (const auto& file_device = audio_state.device.file; file_device && file_device->length() > 0) {
+                const auto sample_rate = static_cast<float>(file_device->sample_rate());
+                const float length = static_cast<float>(file_device->length()) / sample_rate;
+                float position = static_cast<float>(file_device->position()) / sample_rate;
+                if (ImGui::SliderFloat("position", &position, 0.0f, length, "%.1f s")) {
+                    file_device->seek(static_cast<ma_uint64>(position * sample_rate));
+                }
+            }
+        }
+
+        if (const auto& recording = audio_state.replay.recording) {
+            ImGui::Text(
+                "replay: frame %llu / %llu",
+                static_cast<unsigned long long>(recording->position()),
+                static_cast<unsigned long long>(recording->header().frame_count)
+            );
+        }
+
+        bool record = static_cast<bool>(audio_state.recording.recorder);
+        if (ImGui::Checkbox("record spectra", &record)) {
+            audio_state.recording_controls.record.set(record);
+        }
+
+        bool use_worker = audio_state.analysis_controls.use_worker.get().value_or(false);
+        if (ImGui::Checkbox("analysis thread", &use_worker)) {
+            audio_state.analysis_controls.use_worker.set_if_ne(use_worker);
+        }
+
+        auto& analysis_controls = audio_state.analysis_controls;
+        const auto size_combo = [](const char* label, std::size_t current, auto options, auto&& on_select) {
+            const std::string preview = std::to_string(current);
+            if (ImGui::BeginCombo(label, preview.c_str())) {
+                for (const std::size_t option : options) {
+                    const std::string option_name = std::to_string(option);
+                    if (ImGui::Selectable(option_name.c_str(), option == current)) {
+                        on_select(option);
+                    }
+                }
+                ImGui::EndCombo();
+            }
+        };
+        constexpr auto fft_sizes = std::to_array<std::size_t>({ 256, 512, 1024, 2048, 4096, 8192 });
+        size_combo("fft size", config.frame_count, fft_sizes, [&](std::size_t frame_count) {
+            analysis_controls.frame_count.set_if_ne(frame_count);
+            // keep the overlap ratio
+            analysis_controls.frame_window.set_if_ne(frame_count * config.frame_window / config.frame_count);
+        });
+        const std::array hops{
+            config.frame_count,
+            config.frame_count / 2,
+            config.frame_count / 4,
+            config.frame_count / 8,
+        };
+        size_combo("hop", config.frame_window, hops, [&](std::size_t frame_window) {
+            analysis_controls.frame_window.set_if_ne(frame_window);
+        });
+        const std::array max_frame_counts{
+            config.frame_count * 2,
+            config.frame_count * 4,
+            config.frame_count * 8,
+            config.frame_count * 16,
+        };
+        size_combo("buffered frames", config.max_frame_count, max_frame_counts, [&](std::size_t max_frame_count) {
+            analysis_controls.max_frame_count.set_if_ne(max_frame_count);
+        });
+
+        constexpr auto latency_mode_to_name = [](audio::LatencyMode latency_mode) -> const char* {
+            switch (latency_mode) {
+            case audio::LatencyMode::NEWEST:
+                return "newest window";
+            case audio::LatencyMode::CATCH_UP:
+                return "catch up";
+            default:
+                break;
+            }
+            return "unknown";
+        };
+        audio::LatencyPolicy latency_policy = analysis_controls.latency_policy.get().value_or(audio::LatencyPolicy{});
+        if (ImGui::BeginCombo("latency", latency_mode_to_name(latency_policy.mode))) {
+            for (const auto latency_mode : { audio::LatencyMode::NEWEST, audio::LatencyMode::CATCH_UP }) {
+                if (ImGui::Selectable(latency_mode_to_name(latency_mode), latency_mode == latency_policy.mode)) {
+                    latency_policy.mode = latency_mode;
+                    analysis_controls.latency_policy.set_if_ne(latency_policy);
+                }
+            }
+            ImGui::EndCombo();
+        }
+        if (latency_policy.mode == audio::LatencyMode::CATCH_UP) {
+            int max_backlog = static_cast<int>(latency_policy.max_backlog);
+            if (ImGui::SliderInt("max backlog, windows", &max_backlog, 1, 32)) {
+                latency_policy.max_backlog = static_cast<std::size_t>(max_backlog);
+                analysis_controls.latency_policy.set_if_ne(latency_policy);
+            }
+        }
+
+        constexpr auto spectrum_mode_to_name = [](SpectrumMode spectrum_mode) -> const char* {
+            switch (spectrum_mode) {
+            case SpectrumMode::FFT:
+                return "fft bands";
+            case SpectrumMode::MULTI_RESOLUTION:
+                return "multi-resolution bands";
+            case SpectrumMode::CONSTANT_Q:
+                return "constant-q";
+            case SpectrumMode::VARIABLE_Q:
+                return "variable-q";
+            default:
+                break;
+            }
+            return "unknown";
+        };
+        const SpectrumMode spectrum_mode = analysis_controls.spectrum_mode.get().value_or(SpectrumMode::FFT);
+        if (ImGui::BeginCombo("spectrum", spectrum_mode_to_name(spectrum_mode))) {
+            for (const auto mode : {
+                     SpectrumMode::FFT,
+                     SpectrumMode::MULTI_RESOLUTION,
+                     SpectrumMode::CONSTANT_Q,
+                     SpectrumMode::VARIABLE_Q,
+                 }) {
+                if (ImGui::Selectable(spectrum_mode_to_name(mode), mode == spectrum_mode)) {
+                    analysis_controls.spectrum_mode.set_if_ne(mode);
+                }
+            }
+            ImGui::EndCombo();
+        }
+
+        constexpr auto window_function_to_name = [](audio::WindowFunction window_function) -> const char* {
+            switch (window_function) {
+            case audio::WindowFunction::RECTANGULAR:
+                return "rectangular";
+            case audio::WindowFunction::HANN:
+                return "hann";
+            case audio::WindowFunction::HAMMING:
+                return "hamming";
+            case audio::WindowFunction::BLACKMAN_HARRIS:
+                return "blackman-harris";
+            case audio::WindowFunction::FLAT_TOP:
+                return "flat-top";
+            default:
+                break;
+            }
+            return "unknown";
+        };
+        // constant-Q kernels are windowed already
+        if (!audio_state.analyzer->is_constant_q()) {
+            const audio::WindowFunction window_function = audio_state.analyzer->window_function();
+            if (ImGui::BeginCombo("window", window_function_to_name(window_function))) {
+                for (const auto function : {
+                         audio::WindowFunction::RECTANGULAR,
+                         audio::WindowFunction::HANN,
+                         audio::WindowFunction::HAMMING,
+                         audio::WindowFunction::BLACKMAN_HARRIS,
+                         audio::WindowFunction::FLAT_TOP,
+                     }) {
+                    const bool is_selected = function == window_function;
+                    if (ImGui::Selectable(window_function_to_name(function), is_selected) && !is_selected) {
+                        analysis_controls.window_function.set(function);
+                    }
+                }
+                ImGui::EndCombo();
+            }
+        }
+
+        constexpr auto band_scale_to_name = [](audio::BandScale band_scale) -> const char* {
+            switch (band_scale) {
+            case audio::BandScale::LINEAR:
+                return "linear";
+            case audio::BandScale::LOG:
+                return "log";
+            case audio::BandScale::MEL:
+                return "mel";
+            case audio::BandScale::BARK:
+                return "bark";
+            default:
+                break;
+            }
+            return "unknown";
+        };
+        // constant-q bins are published as they are, bands only apply to the fft spectrum
+        if (!audio_state.analyzer->is_constant_q()) {
+            audio::BandConfig band_config = audio_state.band_map.config();
+            if (ImGui::BeginCombo("band scale", band_scale_to_name(band_config.scale))) {
+                for (const auto band_scale : {
+                         audio::BandScale::LINEAR,
+                         audio::BandScale::LOG,
+                         audio::BandScale::MEL,
+                         audio::BandScale::BARK,
+                     }) {
+                    if (ImGui::Selectable(band_scale_to_name(band_scale), band_scale == band_config.scale)) {
+                        band_config.scale = band_scale;
+                        analysis_controls.band_config.set(band_config);
+                    }
+                }
+                ImGui::EndCombo();
+            }
+            constexpr auto band_counts = std::to_array<std::size_t>({ 32, 64, 128, 256, 512 });
+            size_combo("bands", band_config.bands, band_counts, [&](std::size_t bands) {
+                band_config.bands = bands;
+                analysis_controls.band_config.set(band_config);
+            });
+        } else {
+            ImGui::Text("constant-q bins: %zu", audio_state.analyzer->bins());
+        }
+
+        if (auto* render_state = layer.registry.try_get<RenderState>(render_entity)) {
+            const GLuint current_row = render_state->nfdo_row.get().value_or(0u);
+            const std::string_view preview_row = audio::planar_row_name(config.capture_channels, current_row);
+            if (ImGui::BeginCombo("spectrum row", preview_row.data())) {
+                for (std::size_t row = 0; row < audio::planar_rows(config.capture_channels); ++row) {
+                    const std::string_view row_name = audio::planar_row_name(config.capture_channels, row);
+                    if (ImGui::Selectable(row_name.data())) {
+                        render_state->nfdo_row.set_if_ne(static_cast<GLuint>(row));
+                    }
+                }
+                ImGui::EndCombo();
+            }
+        }
     }
 
     if (auto imgui_window = imgui_frame.begin( //
@@ -265,39 +907,57 @@ void audio_overlay(
         ImGui::SetWindowSize(debug_window_size);
         ImGui::SetWindowPos(debug_window_pos);
 
+        // window is visible, so only now time and frequency domain are snapshotted and debug intermediates computed
+        if (audio_state.worker) {
+            audio_state.worker->request_snapshot();
+        } else {
+            audio_state.intermediate.snapshot_requested = true;
+        }
+        const audio::Spectrum& spectrum = audio_latest_spectrum(audio_state);
+        audio_update_debug_intermediates(spectrum, audio_state.intermediate);
+
         ImGui::Text("FPS: %.1f", static_cast<double>(ImGui::GetIO().Framerate));
         ImGui::Text("sound level: %.3f", static_cast<double>(audio_state.intermediate.sound_level));
+        ImGui::Text(
+            "capture: %s, %u channels, %u Hz",
+            ma_get_format_name(config.format),
+            static_cast<unsigned>(config.capture_channels),
+            static_cast<unsigned>(config.sample_rate)
+        );
+        ImGui::Text(
+            "window: %zu frames, hop: %zu frames (%s), hop rate: %.1f/s",
+            config.frame_count,
+            config.frame_window,
+            config.is_sliding() ? "sliding" : "no overlap",
+            static_cast<double>(config.hop_rate())
+        );
+        ImGui::Text(
+            "dropped frames: %llu, skipped frames: %llu, buffer: %zu KiB",
+            static_cast<unsigned long long>(audio_state.callback->dropped_frames(config)),
+            static_cast<unsigned long long>(audio_state.callback->skipped_frames(config)),
+            audio_state.callback->buffer_bytes() / 1024
+        );
 
         if (ImPlot::BeginPlot("time_domain", ImVec2{ -1.0f, 300.0f })) {
-            const auto& vec = audio_state.intermediate.time_domain;
+            const auto& vec = spectrum.time_domain;
 
             ImPlot::SetupAxisLimits(ImAxis_X1, 0.0, static_cast<double>(vec.size()), ImPlotCond_Always);
             ImPlot::SetupAxisLimits(ImAxis_Y1, -1.0, 1.0, ImPlotCond_Always);
 
-            ImPlot::PlotLineG(
-                "f(t)",
-                [](int idx, void* data) {
-                    return ImPlotPoint{
-                        static_cast<double>(idx),
-                        static_cast<double>(static_cast<const std::complex<float>*>(data)[idx].real()),
-                    };
-                },
-                (void*)vec.data(),
-                static_cast<int>(vec.size())
-            );
+            ImPlot::PlotLine("f(t)", vec.data(), static_cast<int>(vec.size()));
 
             ImPlot::EndPlot();
         }
 
         if (ImPlot::BeginPlot("freq_domain (abs)", ImVec2{ -1.0f, 300.0f })) {
-            const auto& vec = audio_state.intermediate.freq_domain;
-            const double log_max_amp = std::log(static_cast<double>(vec.size()));
+            const auto& vec = spectrum.freq_domain;
+            const double log_max_amp = std::log(static_cast<double>(config.frame_count));
 
             ImPlot::SetupAxisLimits(ImAxis_X1, 0.0, static_cast<double>(vec.size()), ImPlotCond_Always);
             ImPlot::SetupAxisLimits(ImAxis_Y1, 0.0, log_max_amp, ImPlotCond_Always);
 
             ImPlot::PlotLineG(
-                "|F(omega)|",
+                "|F(omega)|, omega in [0..Omega/2]",
                 [](int idx, void* data) {
                     return ImPlotPoint{
                         static_cast<double>(idx),
@@ -337,7 +997,7 @@ void audio_overlay(
         }
 
         if (ImPlot::BeginPlot("normalized_freq_domain_output", ImVec2{ -1.0f, 300.0f })) {
-            const auto& vec = audio_state.intermediate.normalized_freq_domain_output;
+            const auto vec = spectrum.row(0);
 
             ImPlot::SetupAxisScale(ImAxis_X1, ImPlotScale_Log10);
             ImPlot::SetupAxisLimits(ImAxis_X1, 1.0, static_cast<double>(vec.size()), ImPlotCond_Always);
@@ -352,4 +1012,72 @@ void audio_overlay(
     }
 }
 
+void performance_overlay(sl::gfx::imgui_frame& imgui_frame) {
+    // outside of the window, so the hotkey works even when it is collapsed
+    if (perf::trace::is_enabled() && ImGui::IsKeyPressed(ImGuiKey_F12, false)) {
+        perf::trace::dump();
+    }
+
+    if (auto imgui_window = imgui_frame.begin("performance")) {
+        constexpr auto to_us = [](std::chrono::nanoseconds duration) {
+            return std::chrono::duration<double, std::micro>{ duration }.count();
+        };
+        constexpr auto stage_count = static_cast<std::size_t>(perf::Stage::ENUM_END);
+
+        if (ImGui::BeginTable("stages", 5)) {
+            ImGui::TableSetupColumn("stage");
+            ImGui::TableSetupColumn("count");
+            ImGui::TableSetupColumn("p50, us");
+            ImGui::TableSetupColumn("p99, us");
+            ImGui::TableSetupColumn("max, us");
+            ImGui::TableHeadersRow();
+            const auto summary_row = [&](const char* name, const perf::Histogram& histogram) {
+                const perf::Histogram::Summary summary = histogram.summary();
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(name);
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(summary.count));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f", to_us(summary.p50));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f", to_us(summary.p99));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f", to_us(summary.max));
+            };
+            for (std::size_t stage_index = 0; stage_index < stage_count; ++stage_index) {
+                const auto stage = static_cast<perf::Stage>(stage_index);
+                summary_row(perf::stage_name(stage).data(), perf::histogram(stage));
+            }
+            // tune frame_count and max_frame_count against this one
+            summary_row("capture to upload", perf::capture_latency());
+            ImGui::EndTable();
+        }
+
+        if (perf::realtime::is_checked()) {
+            const perf::realtime::Violations violations = perf::realtime::violations();
+            ImGui::Text(
+                "real-time violations: %llu allocations, %llu frees, %llu blocking calls",
+                static_cast<unsigned long long>(violations.allocations),
+                static_cast<unsigned long long>(violations.deallocations),
+                static_cast<unsigned long long>(violations.blocking_calls)
+            );
+        }
+
+        if (ImGui::Button("reset")) {
+            for (std::size_t stage_index = 0; stage_index < stage_count; ++stage_index) {
+                perf::histogram(static_cast<perf::Stage>(stage_index)).reset();
+            }
+            perf::capture_latency().reset();
+            perf::realtime::reset();
+        }
+        if (perf::trace::is_enabled()) {
+            ImGui::SameLine();
+            if (ImGui::Button("dump trace (F12)")) {
+                perf::trace::dump();
+            }
+        }
+    }
+}
+
 } // namespace visualizer
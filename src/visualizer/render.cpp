@@ -4,11 +4,16 @@
 
 #include "visualizer/render.hpp"
 
+#include "perf/histogram.hpp"
+#include "perf/trace.hpp"
+
 #include <glm/gtc/type_ptr.hpp>
 #include <imgui.h>
 #include <sl/game/graphics/buffer.hpp>
 #include <sl/meta/enum/to_string.hpp>
 
+#include <cmath>
+
 namespace visualizer {
 
 sl::exec::async<sl::game::shader>
@@ -32,6 +37,9 @@ sl::exec::async<sl::game::shader>
     auto set_ray_origin = *ASSERT_VAL(bound_sp.make_uniform_setter(glUniform3f, "u_ray_origin"));
     auto set_ray_pitch = *ASSERT_VAL(bound_sp.make_uniform_setter(glUniform1f, "u_ray_pitch"));
     auto set_sound_level = *ASSERT_VAL(bound_sp.make_uniform_setter(glUniform1f, "u_sound_level"));
+    auto set_nfdo_row = *ASSERT_VAL(bound_sp.make_uniform_setter(glUniform1ui, "u_nfdo_row"));
+    auto set_nfdo_N = *ASSERT_VAL(bound_sp.make_uniform_setter(glUniform1ui, "u_nfdo_N"));
+    auto set_nfdo_log_N = *ASSERT_VAL(bound_sp.make_uniform_setter(glUniform1f, "u_nfdo_log_N"));
 
     sl::gfx::buffer<float, sl::gfx::buffer_type::texture, sl::gfx::buffer_usage::dynamic_draw> tbo;
     tbo.bind().initialize_data(ssbo_size);
@@ -49,22 +57,36 @@ sl::exec::async<sl::game::shader>
                     set_time = std::move(set_time),
                     set_window_size = std::move(set_window_size),
                     tbo = std::move(tbo),
+                    tbo_size = ssbo_size,
                     tex = std::move(tex),
                     set_ray_origin = std::move(set_ray_origin),
                     set_ray_pitch = std::move(set_ray_pitch),
                     set_sound_level = std::move(set_sound_level),
+                    set_nfdo_row = std::move(set_nfdo_row),
+                    set_nfdo_N = std::move(set_nfdo_N),
+                    set_nfdo_log_N = std::move(set_nfdo_log_N),
                     render_entity](
                     sl::ecs::layer& layer, //
                     const sl::game::camera_frame&,
                     const sl::gfx::bound_shader_program& bound_sp
                 ) mutable {
+            const perf::trace::Scope trace{ "shader setup" };
             if (auto* state = layer.registry.try_get<RenderState>(render_entity)) {
                 state->normalized_freq_proc_output.release().map([&](const std::vector<float>& output) {
+                    const perf::ScopedTimer timer{ perf::Stage::TBO_UPLOAD };
                     auto bound_ssbo = tbo.bind();
+                    // grows only, so switching fft size or device back and forth reuses the same storage
+                    if (output.size() > tbo_size) {
+                        bound_ssbo.initialize_data(output.size());
+                        tbo_size = output.size();
+                    }
                     auto maybe_mapped_ssbo = bound_ssbo.template map<sl::gfx::buffer_access::write_only>();
                     auto mapped_ssbo = *ASSERT_VAL(std::move(maybe_mapped_ssbo));
                     auto mapped_ssbo_data = mapped_ssbo.data();
                     std::copy(output.begin(), output.end(), mapped_ssbo_data.begin());
+                    state->captured_at.release().map([](std::chrono::steady_clock::time_point captured_at) {
+                        perf::capture_latency().record(std::chrono::steady_clock::now() - captured_at);
+                    });
                 });
                 state->window_size.release().map([&](const glm::fvec2& window_size) {
                     set_window_size(bound_sp, window_size);
@@ -78,12 +100,19 @@ sl::exec::async<sl::game::shader>
                 });
                 state->ray_pitch.release().map([&](float ray_pitch) { set_ray_pitch(bound_sp, ray_pitch); });
                 state->sound_level.release().map([&](float sound_level) { set_sound_level(bound_sp, sound_level); });
+                state->nfdo_row.release().map([&](GLuint nfdo_row) { set_nfdo_row(bound_sp, nfdo_row); });
+                state->nfdo_bins.release().map([&](GLuint nfdo_bins) {
+                    set_nfdo_N(bound_sp, nfdo_bins);
+                    set_nfdo_log_N(bound_sp, std::log(static_cast<float>(nfdo_bins)));
+                });
             }
 
             return [&, bound_tex = tex.bind()] //
                 (const sl::gfx::bound_vertex_array& bound_va,
                  sl::game::vertex::draw_type& vertex_draw,
                  std::span<const entt::entity>) {
+                    const perf::trace::Scope trace{ "draw" };
+                    const perf::ScopedTimer timer{ perf::Stage::DRAW };
                     sl::gfx::draw draw{ bound_sp, bound_va };
                     vertex_draw(draw);
                 };
@@ -121,6 +150,8 @@ sl::exec::async<entt::entity>
         entity,
         RenderState{
             .normalized_freq_proc_output{},
+            .nfdo_row{ 0u },
+            .nfdo_bins{},
             .ray_origin{ glm::fvec3{ 0.0f, 3.9f, -4.0f } },
             .window_size{ static_cast<glm::fvec2>(window_size) },
             .draw_mode{ DrawMode::RAY_MARCHING },
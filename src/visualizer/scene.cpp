@@ -6,6 +6,9 @@
 #include "visualizer/audio.hpp"
 #include "visualizer/render.hpp"
 
+#include "audio/bands.hpp"
+#include "audio/deinterleave.hpp"
+
 #include <sl/meta.hpp>
 
 namespace visualizer {
@@ -56,8 +59,9 @@ sl::exec::async<void> create_scene(
     const sl::game::basis& world,
     glm::ivec2 window_size
 ) {
+    // initial analysis parameters, adjustable at runtime from the overlay
     constexpr audio::DataConfig audio_config{
-        /* .capture_channels = */ 1,
+        /* .capture_channels = */ 2,
         /* .sample_rate = */ 48000,
         /* .frame_count = */ 1024 * 2,
         /* .max_frame_count = */ 1024 * 16,
@@ -75,7 +79,7 @@ sl::exec::async<void> create_scene(
     sl::game::node::attach_child(layer, global_entity, render_entity);
 
     {
-        const auto audio_entity = co_await create_audio_entity(e_ctx, layer, audio_config, render_entity);
+        const auto audio_entity = co_await create_audio_entity(layer, audio_config, render_entity);
         sl::game::node::attach_child(layer, global_entity, audio_entity);
     }
 
@@ -91,7 +95,12 @@ sl::exec::async<void> create_scene(
 
         ASSERT(
             co_await shader_resource->require(
-                "shader.flat"_us(*us_storage), create_flat_shader(e_ctx, audio_config.frame_count / 2, render_entity)
+                "shader.flat"_us(*us_storage),
+                create_flat_shader(
+                    e_ctx,
+                    audio::planar_rows(audio_config.capture_channels) * audio::BandConfig{}.bands,
+                    render_entity
+                )
             )
         );
         ASSERT(co_await vertex_resource->require("vertex.flat"_us(*us_storage), create_flat_vertex()));
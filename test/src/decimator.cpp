@@ -0,0 +1,85 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/decimator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <numbers>
+#include <span>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t signal_size = 4096;
+
+std::vector<float> make_noise(std::size_t size) {
+    std::vector<float> noise(size);
+    std::uint32_t state = 777;
+    for (float& sample : noise) {
+        state = state * 1664525u + 1013904223u;
+        sample = static_cast<float>(state >> 8) / static_cast<float>(1u << 23) - 1.0f;
+    }
+    return noise;
+}
+
+TEST(DecimatorTest, ChunkedOutputIsBitIdenticalToOneShot) {
+    const std::vector<float> input = make_noise(signal_size);
+    for (const std::size_t factor : { 2uz, 4uz, 8uz }) {
+        audio::Decimator one_shot{ factor, signal_size };
+        std::vector<float> expected(signal_size / factor);
+        one_shot.process(input, expected);
+
+        // chunk sizes vary, so outputs land in the vectorized blocks and in the tail at different positions
+        constexpr std::size_t max_chunk = 64 * audio::Decimator::max_factor;
+        audio::Decimator chunked{ factor, max_chunk };
+        std::vector<float> actual(signal_size / factor);
+        const std::size_t chunk_factors[] = { 1, 3, 8, 64, 5 };
+        std::size_t offset = 0;
+        for (std::size_t chunk = 0; offset < signal_size; ++chunk) {
+            const std::size_t chunk_size = chunk_factors[chunk % std::size(chunk_factors)] * factor;
+            const std::size_t size = std::min(chunk_size, signal_size - offset);
+            chunked.process(
+                std::span{ input }.subspan(offset, size), std::span{ actual }.subspan(offset / factor, size / factor)
+            );
+            offset += size;
+        }
+
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_EQ(actual[i], expected[i]) << "factor " << factor << ", output " << i;
+        }
+    }
+}
+
+TEST(DecimatorTest, StopbandToneIsAtLeast60DbDown) {
+    for (const std::size_t factor : { 2uz, 4uz, 8uz }) {
+        const double output_nyquist = 0.5 / static_cast<double>(factor); // of the input rate
+        // from 5/4 of the output nyquist, where the stopband starts, up to the input nyquist
+        for (double ratio = 1.25; ratio * output_nyquist < 0.5; ratio += 0.01) {
+            std::vector<float> input(signal_size);
+            for (std::size_t i = 0; i < signal_size; ++i) {
+                const double phase = 2.0 * std::numbers::pi * ratio * output_nyquist * static_cast<double>(i);
+                input[i] = static_cast<float>(std::sin(phase + 0.3));
+            }
+            audio::Decimator decimator{ factor, signal_size };
+            std::vector<float> output(signal_size / factor);
+            decimator.process(input, output);
+
+            // past the filter delay, the unit tone has settled
+            float peak = 0.0f;
+            const std::size_t settled = audio::Decimator::taps_per_phase;
+            for (std::size_t i = settled; i < output.size(); ++i) {
+                peak = std::max(peak, std::abs(output[i]));
+            }
+            EXPECT_LE(peak, 1e-3f) << "factor " << factor << ", tone at " << ratio << " x output nyquist";
+        }
+    }
+}
+
+} // namespace
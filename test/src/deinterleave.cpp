@@ -0,0 +1,105 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/deinterleave.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <span>
+#include <vector>
+
+namespace {
+
+// four sample codes of one format, little-endian, with the float each one has to come out as
+struct FormatCase {
+    ma_format format;
+    std::vector<std::vector<std::byte>> codes; // min, max, zero, smallest positive
+    std::array<float, 4> expected;
+};
+
+std::vector<std::byte> bytes(std::initializer_list<unsigned> values) {
+    std::vector<std::byte> result;
+    for (const unsigned value : values) {
+        result.push_back(static_cast<std::byte>(value));
+    }
+    return result;
+}
+
+std::vector<FormatCase> format_cases() {
+    return {
+        FormatCase{
+            .format = ma_format_u8,
+            .codes = { bytes({ 0x00 }), bytes({ 0xff }), bytes({ 0x80 }), bytes({ 0x81 }) },
+            .expected = { -1.0f, 127.0f / 128.0f, 0.0f, 1.0f / 128.0f },
+        },
+        FormatCase{
+            .format = ma_format_s16,
+            .codes = { bytes({ 0x00, 0x80 }), bytes({ 0xff, 0x7f }), bytes({ 0x00, 0x00 }), bytes({ 0x01, 0x00 }) },
+            .expected = { -1.0f, 32767.0f / 32768.0f, 0.0f, 1.0f / 32768.0f },
+        },
+        FormatCase{
+            .format = ma_format_s24,
+            .codes = {
+                bytes({ 0x00, 0x00, 0x80 }),
+                bytes({ 0xff, 0xff, 0x7f }),
+                bytes({ 0x00, 0x00, 0x00 }),
+                bytes({ 0x01, 0x00, 0x00 }),
+            },
+            .expected = { -1.0f, 8388607.0f / 8388608.0f, 0.0f, 1.0f / 8388608.0f },
+        },
+        FormatCase{
+            .format = ma_format_s32,
+            .codes = {
+                bytes({ 0x00, 0x00, 0x00, 0x80 }),
+                bytes({ 0xff, 0xff, 0xff, 0x7f }),
+                bytes({ 0x00, 0x00, 0x00, 0x00 }),
+                bytes({ 0x00, 0x01, 0x00, 0x00 }),
+            },
+            // the max code rounds to 1 in float
+            .expected = { -1.0f, 1.0f, 0.0f, 1.0f / 8388608.0f },
+        },
+        FormatCase{
+            .format = ma_format_f32,
+            .codes = {
+                bytes({ 0x00, 0x00, 0x80, 0xbf }),
+                bytes({ 0x00, 0x00, 0x80, 0x3f }),
+                bytes({ 0x00, 0x00, 0x00, 0x00 }),
+                bytes({ 0x00, 0x00, 0x00, 0x3f }),
+            },
+            .expected = { -1.0f, 1.0f, 0.0f, 0.5f },
+        },
+    };
+}
+
+TEST(DeinterleaveTest, ConvertsEveryFormatIntoMidLeftRightSide) {
+    for (const FormatCase& format_case : format_cases()) {
+        // frame i is code i on the left and code 3 - i on the right, so every code is seen in both channels
+        constexpr std::size_t frames = 4;
+        std::vector<std::byte> input;
+        for (std::size_t frame = 0; frame < frames; ++frame) {
+            const auto& left = format_case.codes[frame];
+            const auto& right = format_case.codes[frames - 1 - frame];
+            input.insert(input.end(), left.begin(), left.end());
+            input.insert(input.end(), right.begin(), right.end());
+        }
+
+        std::array<std::array<float, frames>, 4> planar{};
+        const std::array<std::span<float>, 4> rows{ planar[0], planar[1], planar[2], planar[3] };
+        audio::deinterleave(input, format_case.format, 2, rows);
+
+        for (std::size_t frame = 0; frame < frames; ++frame) {
+            const float left = format_case.expected[frame];
+            const float right = format_case.expected[frames - 1 - frame];
+            EXPECT_FLOAT_EQ(planar[1][frame], left) << format_case.format << ", frame " << frame;
+            EXPECT_FLOAT_EQ(planar[2][frame], right) << format_case.format << ", frame " << frame;
+            EXPECT_FLOAT_EQ(planar[0][frame], (left + right) * 0.5f) << format_case.format << ", frame " << frame;
+            EXPECT_FLOAT_EQ(planar[3][frame], (left - right) * 0.5f) << format_case.format << ", frame " << frame;
+        }
+    }
+}
+
+} // namespace
@@ -0,0 +1,65 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/fft.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <vector>
+
+namespace {
+
+// deterministic input with a dc offset, so that neither dc nor nyquist come out as zero
+std::vector<float> make_input(std::size_t size) {
+    std::vector<float> input(size);
+    std::uint32_t state = 12345;
+    for (float& sample : input) {
+        state = state * 1664525u + 1013904223u;
+        sample = 0.25f + static_cast<float>(state >> 8) / static_cast<float>(1u << 24) - 0.5f;
+    }
+    return input;
+}
+
+// single bin of the naive dft, in double
+std::complex<double> naive_bin(const std::vector<float>& input, std::size_t bin) {
+    const std::size_t size = input.size();
+    std::complex<double> sum{};
+    for (std::size_t n = 0; n < size; ++n) {
+        const std::size_t phase = bin * n % size; // exact, so large sizes do not lose the angle
+        const double angle = -2.0 * std::numbers::pi * static_cast<double>(phase) / static_cast<double>(size);
+        sum += static_cast<double>(input[n]) * std::complex<double>{ std::cos(angle), std::sin(angle) };
+    }
+    return sum;
+}
+
+TEST(FftTest, RealForwardMatchesNaiveDft) {
+    for (const std::size_t size : { 2uz, 4uz, 256uz, 65536uz }) {
+        const audio::RealFft fft{ size };
+        const std::vector<float> input = make_input(size);
+        std::vector<std::complex<float>> output(fft.bins());
+        fft.forward(input, output);
+
+        // float rounding grows with log N steps over values of about sqrt N
+        const double tolerance = 1e-5 * std::sqrt(static_cast<double>(size)) * std::log2(static_cast<double>(size));
+        std::vector<std::size_t> checked_bins{ 0, size / 2 }; // dc and nyquist, both purely real
+        if (size > 2) {
+            checked_bins.push_back(size / 4); // interior, k = M / 2 of the half size fft is untangled on its own
+        }
+        if (size > 4) {
+            checked_bins.push_back(size / 2 - 1); // interior, an ordinary k paired with M - k
+        }
+        for (const std::size_t bin : checked_bins) {
+            const std::complex<double> expected = naive_bin(input, bin);
+            EXPECT_NEAR(output[bin].real(), expected.real(), tolerance) << "size " << size << ", bin " << bin;
+            EXPECT_NEAR(output[bin].imag(), expected.imag(), tolerance) << "size " << size << ", bin " << bin;
+        }
+    }
+}
+
+} // namespace
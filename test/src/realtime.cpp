@@ -0,0 +1,90 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/analyzer.hpp"
+#include "audio/synthetic.hpp"
+#include "perf/realtime.hpp"
+#include "perf/trace.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+TEST(RealtimeTest, InterposerCountsOnlyRealtimeThreads) {
+    ASSERT_TRUE(perf::realtime::is_checked());
+    perf::realtime::reset();
+
+    int* volatile outside = new int{ 1 };
+    delete outside;
+    EXPECT_EQ(perf::realtime::violations().total(), 0u);
+
+    std::mutex mutex;
+    {
+        const perf::realtime::Section realtime;
+        int* volatile inside = new int{ 2 };
+        delete inside;
+        const std::lock_guard lock{ mutex };
+    }
+    const perf::realtime::Violations violations = perf::realtime::violations();
+    EXPECT_EQ(violations.allocations, 1u);
+    EXPECT_EQ(violations.deallocations, 1u);
+    EXPECT_EQ(violations.blocking_calls, 1u);
+}
+
+TEST(RealtimeTest, SyntheticDeviceCallbackNeitherAllocatesNorBlocks) {
+    ASSERT_TRUE(perf::realtime::is_checked());
+    constexpr audio::DataConfig config{ 2, 48000, 1024, 1024 * 4, 256 };
+    audio::DataCallback callback{ config };
+    audio::Analyzer analyzer{ config };
+    audio::Spectrum spectrum{ config };
+    perf::realtime::reset();
+
+    {
+        // two seconds of audio in about a tenth of a second
+        const audio::SyntheticDevice device{ config, audio::SyntheticConfig{ .speed = 16.0 }, callback };
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{ 5 };
+        while (device.generated_frames() < config.sample_rate * 2 && std::chrono::steady_clock::now() < deadline) {
+            if (!analyzer.update(callback, spectrum, false)) {
+                std::this_thread::yield();
+            }
+        }
+        EXPECT_GE(device.generated_frames(), config.sample_rate * 2);
+    }
+
+    EXPECT_GT(spectrum.generation, 0);
+    const perf::realtime::Violations violations = perf::realtime::violations();
+    EXPECT_EQ(violations.allocations, 0u);
+    EXPECT_EQ(violations.deallocations, 0u);
+    EXPECT_EQ(violations.blocking_calls, 0u);
+}
+
+TEST(RealtimeTest, FirstTraceCallOfAThreadNeitherAllocatesNorBlocks) {
+    ASSERT_TRUE(perf::realtime::is_checked());
+    if (!perf::trace::is_enabled()) {
+        perf::trace::enable(std::filesystem::temp_directory_path() / "smv-realtime-test.json");
+    }
+    perf::realtime::reset();
+
+    // like device threads of miniaudio, each one traces for the first time from inside the callback
+    for (int device = 0; device < 4; ++device) {
+        std::thread{ [] {
+            const perf::realtime::Section realtime;
+            perf::trace::name_thread("audio device");
+            const perf::trace::Scope trace{ "DataCallback" };
+        } }.join();
+        perf::trace::release_thread("audio device");
+    }
+
+    const perf::realtime::Violations violations = perf::realtime::violations();
+    EXPECT_EQ(violations.allocations, 0u);
+    EXPECT_EQ(violations.deallocations, 0u);
+    EXPECT_EQ(violations.blocking_calls, 0u);
+}
+
+} // namespace
@@ -0,0 +1,206 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/recording.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t rows = 2;
+constexpr std::size_t bins = 16;
+constexpr std::size_t frames = 40;
+constexpr std::uint32_t keyframe_interval = 8;
+
+std::filesystem::path temp_path(const std::string& name) {
+    return std::filesystem::temp_directory_path() / ("smv-recording-test-" + name + ".smvr");
+}
+
+std::chrono::nanoseconds frame_timestamp(std::size_t frame) { return std::chrono::milliseconds{ 20 } * frame; }
+
+float frame_value(std::size_t frame, std::size_t i) {
+    return std::sin(0.3f * static_cast<float>(frame) + 0.7f * static_cast<float>(i));
+}
+
+void record(const std::filesystem::path& path, audio::Quantization quantization) {
+    auto maybe_recorder = audio::SpectrumRecorder::create(path, rows, bins, quantization, keyframe_interval);
+    ASSERT_TRUE(maybe_recorder);
+    audio::SpectrumRecorder& recorder = **maybe_recorder;
+    std::vector<float> normalized(rows * bins);
+    for (std::size_t frame = 0; frame < frames; ++frame) {
+        for (std::size_t i = 0; i < normalized.size(); ++i) {
+            normalized[i] = frame_value(frame, i);
+        }
+        recorder.write(frame_timestamp(frame), static_cast<float>(frame) / frames, normalized);
+    }
+    EXPECT_TRUE(recorder.close());
+}
+
+std::vector<std::byte> read_bytes(const std::filesystem::path& path) {
+    std::ifstream stream{ path, std::ios::binary };
+    std::vector<char> chars{ std::istreambuf_iterator<char>{ stream }, std::istreambuf_iterator<char>{} };
+    std::vector<std::byte> bytes(chars.size());
+    std::transform(chars.begin(), chars.end(), bytes.begin(), [](char c) { return static_cast<std::byte>(c); });
+    return bytes;
+}
+
+void write_bytes(const std::filesystem::path& path, const std::vector<std::byte>& bytes) {
+    std::ofstream stream{ path, std::ios::binary | std::ios::trunc };
+    stream.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+// decodes every frame and seeks around, errors are fine, crashes and endless loops are not
+void decode_everything(const std::filesystem::path& path) {
+    auto maybe_recording = audio::SpectrumRecording::open(path);
+    if (!maybe_recording) {
+        return;
+    }
+    audio::SpectrumRecording& recording = *maybe_recording;
+    audio::RecordedFrame frame;
+    for (std::size_t i = 0; i <= frames; ++i) {
+        auto decoded = recording.next(frame);
+        if (!decoded || !*decoded) {
+            break;
+        }
+    }
+    for (const std::uint64_t frame_index : { 0uz, 5uz, 17uz, frames - 1, frames }) {
+        [[maybe_unused]] auto sought = recording.seek(frame_index);
+    }
+}
+
+TEST(RecordingTest, RoundTripsWithinQuantization) {
+    for (const auto quantization : { audio::Quantization::U8, audio::Quantization::U16 }) {
+        const auto path = temp_path("round-trip");
+        record(path, quantization);
+        const float tolerance = quantization == audio::Quantization::U8 ? 1.0f / 255.0f : 1.0f / 65535.0f;
+
+        auto maybe_recording = audio::SpectrumRecording::open(path);
+        ASSERT_TRUE(maybe_recording);
+        audio::SpectrumRecording& recording = *maybe_recording;
+        EXPECT_EQ(recording.header().rows, rows);
+        EXPECT_EQ(recording.header().bins, bins);
+        EXPECT_EQ(recording.header().frame_count, frames);
+
+        audio::RecordedFrame frame;
+        for (std::size_t expected = 0; expected < frames; ++expected) {
+            auto decoded = recording.next(frame);
+            ASSERT_TRUE(decoded && *decoded);
+            EXPECT_EQ(frame.timestamp, frame_timestamp(expected));
+            EXPECT_NEAR(frame.sound_level, static_cast<float>(expected) / frames, 1.0f / 65535.0f);
+            for (std::size_t i = 0; i < rows * bins; ++i) {
+                ASSERT_NEAR(frame.normalized[i], frame_value(expected, i), tolerance * 1.01f);
+            }
+        }
+        auto past_end = recording.next(frame);
+        ASSERT_TRUE(past_end);
+        EXPECT_FALSE(*past_end);
+
+        // between keyframes, so that seek decodes forward
+        ASSERT_TRUE(recording.seek(19));
+        EXPECT_EQ(recording.position(), 19u);
+        auto decoded = recording.next(frame);
+        ASSERT_TRUE(decoded && *decoded);
+        EXPECT_EQ(frame.timestamp, frame_timestamp(19));
+        EXPECT_NEAR(frame.normalized[3], frame_value(19, 3), tolerance * 1.01f);
+
+        std::filesystem::remove(path);
+    }
+}
+
+TEST(RecordingTest, HeaderIsLittleEndian) {
+    const auto path = temp_path("header");
+    record(path, audio::Quantization::U16);
+    const std::vector<std::byte> bytes = read_bytes(path);
+    ASSERT_GE(bytes.size(), audio::RecordingHeader::encoded_size);
+
+    const auto u32_at = [&bytes](std::size_t offset) {
+        std::uint32_t value = 0;
+        for (std::size_t i = 0; i < 4; ++i) {
+            value |= std::to_integer<std::uint32_t>(bytes[offset + i]) << (8 * i);
+        }
+        return value;
+    };
+    EXPECT_EQ(static_cast<char>(bytes[0]), 'S');
+    EXPECT_EQ(static_cast<char>(bytes[3]), 'R');
+    EXPECT_EQ(u32_at(4), audio::RecordingHeader::expected_version);
+    EXPECT_EQ(u32_at(8), rows);
+    EXPECT_EQ(u32_at(12), bins);
+    EXPECT_EQ(u32_at(16), static_cast<std::uint32_t>(audio::Quantization::U16));
+    EXPECT_EQ(u32_at(20), keyframe_interval);
+    EXPECT_EQ(u32_at(24), frames); // low half of the u64
+    EXPECT_EQ(u32_at(28), 0u);
+
+    std::filesystem::remove(path);
+}
+
+TEST(RecordingTest, UnclosedOrTruncatedRecordingIsRejected) {
+    const auto path = temp_path("truncated");
+    record(path, audio::Quantization::U8);
+    const std::vector<std::byte> bytes = read_bytes(path);
+
+    for (const std::size_t size : { 0uz, 10uz, audio::RecordingHeader::encoded_size, bytes.size() - 1 }) {
+        write_bytes(path, { bytes.begin(), bytes.begin() + static_cast<std::ptrdiff_t>(size) });
+        EXPECT_FALSE(audio::SpectrumRecording::open(path)) << size;
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST(RecordingTest, CorruptFrameIsAnErrorAndKeepsThePosition) {
+    const auto path = temp_path("corrupt");
+    record(path, audio::Quantization::U8);
+    std::vector<std::byte> bytes = read_bytes(path);
+
+    // the second frame is a delta frame, an endless varint makes its timestamp unreadable
+    // the first one is a keyframe of a one byte timestamp, a u16 level and one byte per value
+    const std::size_t second_frame = audio::RecordingHeader::encoded_size + 3 + rows * bins;
+    std::fill_n(bytes.begin() + static_cast<std::ptrdiff_t>(second_frame), 12, std::byte{ 0xff });
+    write_bytes(path, bytes);
+
+    auto maybe_recording = audio::SpectrumRecording::open(path);
+    ASSERT_TRUE(maybe_recording);
+    audio::SpectrumRecording& recording = *maybe_recording;
+    audio::RecordedFrame frame;
+    auto first = recording.next(frame);
+    ASSERT_TRUE(first && *first);
+    const audio::RecordedFrame first_frame = frame;
+
+    EXPECT_FALSE(recording.next(frame));
+    EXPECT_EQ(recording.position(), 1u);
+    EXPECT_EQ(frame.timestamp, first_frame.timestamp);
+    EXPECT_EQ(frame.normalized, first_frame.normalized);
+    EXPECT_FALSE(recording.seek(3));
+
+    std::filesystem::remove(path);
+}
+
+TEST(RecordingTest, AnyCorruptByteNeverCrashes) {
+    const auto path = temp_path("fuzz");
+    record(path, audio::Quantization::U8);
+    const std::vector<std::byte> bytes = read_bytes(path);
+
+    for (const std::byte garbage : { std::byte{ 0x00 }, std::byte{ 0x80 }, std::byte{ 0xff } }) {
+        for (std::size_t offset = 0; offset < bytes.size(); ++offset) {
+            std::vector<std::byte> corrupt = bytes;
+            corrupt[offset] = garbage;
+            write_bytes(path, corrupt);
+            decode_everything(path);
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
+} // namespace
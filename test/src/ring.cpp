@@ -0,0 +1,122 @@
+//
+// Created by usatiynyan.
+//
+
+#include "audio/ring.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <thread>
+
+namespace {
+
+// every word of the stream holds its own word position, so a window is intact iff it counts up from its position
+using Word = std::uint32_t;
+constexpr std::size_t word_size = sizeof(Word);
+constexpr std::size_t chunk_words = 48;
+constexpr std::size_t window_words = 256;
+constexpr std::size_t advance_words = 64;
+constexpr std::size_t chunks_per_yield = 8;
+constexpr std::size_t total_words = chunk_words << 16;
+
+struct HammerResult {
+    std::size_t consumed = 0;
+    std::size_t broken = 0; // accepted windows that do not count up from their position
+    std::size_t out_of_order = 0; // accepted windows that start before the previous one
+};
+
+void produce(audio::Ring& ring, bool wait_for_space) {
+    std::array<Word, chunk_words> chunk{};
+    for (std::size_t word = 0; word < total_words; word += chunk_words) {
+        for (std::size_t i = 0; i < chunk_words; ++i) {
+            chunk[i] = static_cast<Word>(word + i);
+        }
+        while (wait_for_space && ring.available() + chunk_words * word_size > ring.capacity()) {
+            std::this_thread::yield();
+        }
+        ring.push(std::as_bytes(std::span{ chunk }));
+        if (word / chunk_words % chunks_per_yield == 0) { // outruns the consumer by far, but keeps interleaving
+            std::this_thread::yield();
+        }
+    }
+}
+
+HammerResult consume(audio::Ring& ring, const std::atomic<bool>& produced) {
+    HammerResult result;
+    std::array<Word, window_words> window{};
+    std::uint64_t window_position = 0;
+    std::uint64_t last_position = 0;
+    while (true) {
+        const bool done = produced.load(std::memory_order::acquire);
+        const bool consumed = ring.try_consume(
+            window_words * word_size,
+            advance_words * word_size,
+            [&](std::span<const std::byte> input, std::uint64_t position) {
+                // lets the producer in halfway through the read, also on a single core
+                const std::size_t half = input.size() / 2;
+                std::memcpy(window.data(), input.data(), half);
+                std::this_thread::yield();
+                std::memcpy(reinterpret_cast<std::byte*>(window.data()) + half, input.data() + half, half);
+                window_position = position;
+            }
+        );
+        if (!consumed) {
+            if (done && ring.available() < window_words * word_size) {
+                return result;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+
+        const std::uint64_t first_word = window_position / word_size;
+        for (std::size_t i = 0; i < window_words; ++i) {
+            if (window[i] != static_cast<Word>(first_word + i)) {
+                ++result.broken;
+                break;
+            }
+        }
+        if (result.consumed > 0 && window_position <= last_position) {
+            ++result.out_of_order;
+        }
+        last_position = window_position;
+        ++result.consumed;
+    }
+}
+
+HammerResult hammer(audio::Ring& ring, bool wait_for_space) {
+    std::atomic<bool> produced{ false };
+    std::thread producer{ [&] {
+        produce(ring, wait_for_space);
+        produced.store(true, std::memory_order::release);
+    } };
+    const HammerResult result = consume(ring, produced);
+    producer.join();
+    return result;
+}
+
+TEST(RingTest, DropOldestNeverHandsOutTornWindows) {
+    audio::Ring ring{ 1024 * word_size, window_words * word_size, word_size, audio::OverflowPolicy::DROP_OLDEST };
+    const HammerResult result = hammer(ring, false);
+
+    EXPECT_GT(result.consumed, 0u);
+    EXPECT_GT(ring.dropped(), 0u);
+    EXPECT_EQ(result.broken, 0u);
+    EXPECT_EQ(result.out_of_order, 0u);
+}
+
+TEST(RingTest, DropNewestWithoutOverflowHandsOutEveryWindow) {
+    audio::Ring ring{ 1024 * word_size, window_words * word_size, word_size, audio::OverflowPolicy::DROP_NEWEST };
+    const HammerResult result = hammer(ring, true);
+
+    EXPECT_EQ(ring.dropped(), 0u);
+    EXPECT_EQ(result.consumed, (total_words - window_words) / advance_words + 1);
+    EXPECT_EQ(result.broken, 0u);
+    EXPECT_EQ(result.out_of_order, 0u);
+}
+
+} // namespace